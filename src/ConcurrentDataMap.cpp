@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <cassert>
+#include <functional>
+#include <thread>
+
+#include "exported/ConcurrentDataMap.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+ConcurrentDataMap::ReadHandle::ReadHandle (const ConcurrentDataMap & map)
+    : m_map(&map)
+    , m_slot(map.AcquireSlot())
+{
+    // the slot must be visible before the published root is loaded; otherwise
+    //  the writer could reclaim the version between the two.
+    m_root = map.m_published.load();
+}
+
+//=========================================================================
+ConcurrentDataMap::ReadHandle::ReadHandle (ReadHandle && other)
+    : m_map(other.m_map)
+    , m_slot(other.m_slot)
+    , m_root(other.m_root)
+{
+    other.m_map  = nullptr;
+    other.m_root = nullptr;
+}
+
+//=========================================================================
+ConcurrentDataMap::ReadHandle::~ReadHandle () {
+    Release();
+}
+
+//=========================================================================
+DataMapReader ConcurrentDataMap::ReadHandle::GetReader (void) const {
+    return DataMapReader(m_root);
+}
+
+//=========================================================================
+void ConcurrentDataMap::ReadHandle::Release (void) {
+    if (m_map == nullptr)
+        return;
+    m_map->ReleaseSlot(m_slot);
+    m_map  = nullptr;
+    m_root = nullptr;
+}
+
+//=========================================================================
+ConcurrentDataMap::ConcurrentDataMap (void)
+    : m_published(nullptr)
+    , m_globalEpoch(1)
+    , m_pending(nullptr)
+{
+    for (unsigned i = 0;  i < s_maxReaderSlots;  ++i)
+        m_readerSlots[i].m_epoch.store(0, std::memory_order_relaxed);
+
+    DataNode * root = new DataNode("UNNAMED", DataNode::Type::Null);
+    m_published.store(root);
+}
+
+//=========================================================================
+ConcurrentDataMap::~ConcurrentDataMap () {
+    for (unsigned i = 0;  i < s_maxReaderSlots;  ++i) {
+        assert(
+            m_readerSlots[i].m_epoch.load() == 0 &&
+                "ConcurrentDataMap destroyed while a ReadHandle was still pinning it."
+        );
+    }
+
+    for (const RetiredVersion & retired : m_retired)
+        delete retired.m_root;
+    delete m_pending;
+    delete m_published.load();
+}
+
+//=========================================================================
+unsigned ConcurrentDataMap::AcquireSlot (void) const {
+    // start looking at a per-thread position so that readers on different
+    //  threads don't all fight over the first few slots.
+    const unsigned start = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id()) % s_maxReaderSlots);
+
+    for (;;) {
+        const std::uint64_t epoch = m_globalEpoch.load();
+        for (unsigned i = 0;  i < s_maxReaderSlots;  ++i) {
+            ReaderSlot & slot = m_readerSlots[(start + i) % s_maxReaderSlots];
+            std::uint64_t expected = 0;
+            if (slot.m_epoch.load(std::memory_order_relaxed) == 0 &&
+             slot.m_epoch.compare_exchange_strong(expected, epoch))
+                return unsigned(&slot - m_readerSlots);
+        }
+        // every slot is in use.  Wait for some reader to let go of one.
+        std::this_thread::yield();
+    }
+}
+
+//=========================================================================
+void ConcurrentDataMap::ReleaseSlot (unsigned slot) const {
+    m_readerSlots[slot].m_epoch.store(0, std::memory_order_release);
+}
+
+//=========================================================================
+DataMapMutator ConcurrentDataMap::BeginWrite (void) {
+    if (m_pending == nullptr)
+        m_pending = new DataNode(*m_published.load());
+    return DataMapMutator(m_pending);
+}
+
+//=========================================================================
+DataMapMutator ConcurrentDataMap::GetWriteMutator (void) {
+    return DataMapMutator(m_pending);
+}
+
+//=========================================================================
+void ConcurrentDataMap::Publish (void) {
+    #ifdef _DEBUG
+        assert(m_pending && "ConcurrentDataMap::Publish() called, but BeginWrite() was never called.");
+    #endif
+    if (m_pending == nullptr)
+        return;
+
+    DataNode * previous = m_published.exchange(m_pending);
+    m_pending = nullptr;
+
+    // readers pinned at or before this epoch may still be looking at previous.
+    RetiredVersion retired;
+    retired.m_root  = previous;
+    retired.m_epoch = m_globalEpoch.fetch_add(1);
+    m_retired.push_back(retired);
+
+    Reclaim();
+}
+
+//=========================================================================
+void ConcurrentDataMap::AbandonWrite (void) {
+    delete m_pending;
+    m_pending = nullptr;
+}
+
+//=========================================================================
+int ConcurrentDataMap::Reclaim (void) {
+    if (m_retired.empty())
+        return 0;
+
+    // find the oldest epoch any reader is still pinning
+    std::uint64_t oldestPinned = UINT64_MAX;
+    for (unsigned i = 0;  i < s_maxReaderSlots;  ++i) {
+        const std::uint64_t epoch = m_readerSlots[i].m_epoch.load();
+        if (epoch != 0 && epoch < oldestPinned)
+            oldestPinned = epoch;
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0;  i < m_retired.size();  ++i) {
+        if (m_retired[i].m_epoch < oldestPinned)
+            delete m_retired[i].m_root;
+        else
+            m_retired[kept++] = m_retired[i];
+    }
+    m_retired.resize(kept);
+
+    return int(kept);
+}
+
+} // namespace CSaruDataMap
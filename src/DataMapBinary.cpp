@@ -0,0 +1,374 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <process.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "exported/DataMapBinary.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// makes a rename in path's directory durable.  Only POSIX needs telling.
+static void SyncParentDirectory (const char * path) {
+    #ifndef _WIN32
+        std::string directory(path);
+        const std::string::size_type slash = directory.find_last_of('/');
+        directory = slash == std::string::npos ? std::string(".") : directory.substr(0, slash + 1);
+
+        const int fd = open(directory.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    #else
+        (void)path;
+    #endif
+}
+
+//=========================================================================
+// RETURNS: true if a ReadVarint() of size bytes that failed might have
+//  worked with more of them.
+static bool IsVarintCut (std::size_t size) {
+    return size < 10;
+}
+
+//=========================================================================
+// sets *outTruncated when returning 0 because data ends too soon, rather
+//  than because it's malformed.
+static std::size_t ReadNodeAt (const std::uint8_t * data, std::size_t size, DataNode * outNode, int depth, bool * outTruncated) {
+    *outTruncated = false;
+    if (depth > DataMapBinary::s_maxReadDepth)
+        return 0;
+    if (size < 1) {
+        *outTruncated = true;
+        return 0;
+    }
+
+    const std::uint8_t typeByte = data[0];
+    if (typeByte > std::uint8_t(DataNode::Type::String))
+        return 0;
+    const DataNode::Type type = DataNode::Type(typeByte);
+    std::size_t pos = 1;
+
+    std::uint64_t nameLength = 0;
+    std::size_t   read       = DataMapBinary::ReadVarint(data + pos, size - pos, &nameLength);
+    if (read == 0) {
+        *outTruncated = IsVarintCut(size - pos);
+        return 0;
+    }
+    if (nameLength >= DataNode::s_nameSize)
+        return 0;
+    if (nameLength > size - pos - read) {
+        *outTruncated = true;
+        return 0;
+    }
+    pos += read;
+    outNode->SetNameSecure(reinterpret_cast<const char *>(data + pos), int(nameLength));
+    pos += std::size_t(nameLength);
+
+    outNode->DeleteAllChildren();
+    switch (type) {
+        case DataNode::Type::Bool: {
+            if (size - pos < 1) {
+                *outTruncated = true;
+                return 0;
+            }
+            outNode->SetBool(data[pos] != 0);
+            pos += 1;
+        } break;
+
+        case DataNode::Type::Int: {
+            if (size - pos < 4) {
+                *outTruncated = true;
+                return 0;
+            }
+            outNode->SetInt(int(std::int32_t(DataMapBinary::ReadUint32(data + pos))));
+            pos += 4;
+        } break;
+
+        case DataNode::Type::Float: {
+            if (size - pos < 4) {
+                *outTruncated = true;
+                return 0;
+            }
+            const std::uint32_t bits = DataMapBinary::ReadUint32(data + pos);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            outNode->SetFloat(value);
+            pos += 4;
+        } break;
+
+        case DataNode::Type::String: {
+            std::uint64_t length = 0;
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &length);
+            if (read == 0) {
+                *outTruncated = IsVarintCut(size - pos);
+                return 0;
+            }
+            if (length >= DataNode::s_stringDataSize)
+                return 0;
+            if (length > size - pos - read) {
+                *outTruncated = true;
+                return 0;
+            }
+            pos += read;
+            outNode->SetStringSecure(reinterpret_cast<const char *>(data + pos), int(length));
+            pos += std::size_t(length);
+        } break;
+
+        case DataNode::Type::Object:
+        case DataNode::Type::Array: {
+            outNode->SetType(type);
+            std::uint64_t childCount = 0;
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &childCount);
+            if (read == 0) {
+                *outTruncated = IsVarintCut(size - pos);
+                return 0;
+            }
+            // no DataNode holds more; and every child takes at least two bytes.
+            if (childCount > std::uint64_t(INT_MAX))
+                return 0;
+            if (childCount > (size - pos - read) / 2) {
+                *outTruncated = true;
+                return 0;
+            }
+            pos += read;
+
+            outNode->ReserveChildren(int(childCount));
+            for (std::uint64_t i = 0;  i < childCount;  ++i) {
+                read = ReadNodeAt(data + pos, size - pos, outNode->AppendNewChild(), depth + 1, outTruncated);
+                if (read == 0)
+                    return 0;
+                pos += read;
+            }
+        } break;
+
+        default: {
+            outNode->SetType(type);
+        } break;
+    }
+
+    return pos;
+}
+
+//=========================================================================
+void DataMapBinary::AppendNode (const DataNode & node, std::vector<std::uint8_t> * out, bool withChildren) {
+    const int childCount = withChildren ? node.GetChildCount() : 0;
+    AppendNodeHeader(node, childCount, out);
+
+    if (node.IsContainerType()) {
+        for (int i = 0;  i < childCount;  ++i)
+            AppendNode(*node.GetChildFast(i), out);
+    }
+}
+
+//=========================================================================
+void DataMapBinary::AppendNodeHeader (const DataNode & node, int childCount, std::vector<std::uint8_t> * out) {
+    out->push_back(std::uint8_t(node.GetType()));
+
+    const std::size_t nameLength = std::strlen(node.GetName());
+    AppendVarint(nameLength, out);
+    out->insert(out->end(), node.GetName(), node.GetName() + nameLength);
+
+    switch (node.GetType()) {
+        case DataNode::Type::Bool: {
+            out->push_back(node.GetBool() ? 1 : 0);
+        } break;
+
+        case DataNode::Type::Int: {
+            AppendUint32(std::uint32_t(node.GetInt()), out);
+        } break;
+
+        case DataNode::Type::Float: {
+            const float value = node.GetFloat();
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            AppendUint32(bits, out);
+        } break;
+
+        case DataNode::Type::String: {
+            const std::size_t length = std::strlen(node.GetString());
+            AppendVarint(length, out);
+            out->insert(out->end(), node.GetString(), node.GetString() + length);
+        } break;
+
+        case DataNode::Type::Object:
+        case DataNode::Type::Array: {
+            AppendVarint(std::uint64_t(childCount), out);
+        } break;
+
+        default: break;
+    }
+}
+
+//=========================================================================
+void DataMapBinary::AppendUint32 (std::uint32_t value, std::vector<std::uint8_t> * out) {
+    out->push_back(std::uint8_t(value));
+    out->push_back(std::uint8_t(value >> 8));
+    out->push_back(std::uint8_t(value >> 16));
+    out->push_back(std::uint8_t(value >> 24));
+}
+
+//=========================================================================
+void DataMapBinary::AppendVarint (std::uint64_t value, std::vector<std::uint8_t> * out) {
+    while (value >= 0x80) {
+        out->push_back(std::uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(std::uint8_t(value));
+}
+
+//=========================================================================
+bool DataMapBinary::CommitTempFile (std::FILE * file, const char * tempPath, const char * path, bool ok) {
+    ok = SyncFile(file) && ok;
+    ok = std::fclose(file) == 0 && ok;
+
+    #ifdef _WIN32
+        // rename() won't replace an existing file here.
+        if (ok)
+            std::remove(path);
+    #endif
+    if (!ok || std::rename(tempPath, path) != 0) {
+        std::remove(tempPath);
+        return false;
+    }
+
+    SyncParentDirectory(path);
+    return true;
+}
+
+//=========================================================================
+bool DataMapBinary::LoadSnapshot (const char * path, DataNode * outRoot) {
+    std::vector<std::uint8_t> data;
+    if (!ReadFile(path, &data) || data.size() < 4 || ReadUint32(data.data()) != s_snapshotMagic)
+        return false;
+
+    return ReadNode(data.data() + 4, data.size() - 4, outRoot) == data.size() - 4;
+}
+
+//=========================================================================
+std::FILE * DataMapBinary::OpenTempFile (const char * path, std::string * outTempPath) {
+    // unique per process and per call, so that writers racing to replace the
+    //  same file never share a temp file.
+    static std::atomic<unsigned> s_tempCount(0);
+
+    #ifdef _WIN32
+        const unsigned long pid = static_cast<unsigned long>(_getpid());
+    #else
+        const unsigned long pid = static_cast<unsigned long>(getpid());
+    #endif
+
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu.%u.tmp", pid, s_tempCount.fetch_add(1, std::memory_order_relaxed));
+    *outTempPath = std::string(path) + suffix;
+    return std::fopen(outTempPath->c_str(), "wb");
+}
+
+//=========================================================================
+bool DataMapBinary::ReadFile (const char * path, std::vector<std::uint8_t> * outData) {
+    std::FILE * file = std::fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    outData->clear();
+    std::uint8_t buffer[64 * 1024];
+    std::size_t  read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        outData->insert(outData->end(), buffer, buffer + read);
+
+    const bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+//=========================================================================
+std::size_t DataMapBinary::ReadNode (const std::uint8_t * data, std::size_t size, DataNode * outNode, bool * outTruncated) {
+    bool truncated;
+    const std::size_t read = ReadNodeAt(data, size, outNode, 0, &truncated);
+    if (outTruncated)
+        *outTruncated = truncated;
+    return read;
+}
+
+//=========================================================================
+std::uint32_t DataMapBinary::ReadUint32 (const std::uint8_t * data) {
+    return std::uint32_t(data[0])
+        | (std::uint32_t(data[1]) << 8)
+        | (std::uint32_t(data[2]) << 16)
+        | (std::uint32_t(data[3]) << 24);
+}
+
+//=========================================================================
+std::size_t DataMapBinary::ReadVarint (const std::uint8_t * data, std::size_t size, std::uint64_t * outValue) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0;  i < size && i < 10;  ++i) {
+        value |= std::uint64_t(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            *outValue = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+//=========================================================================
+bool DataMapBinary::SaveSnapshot (const char * path, const DataNode & root) {
+    std::vector<std::uint8_t> data;
+    AppendUint32(s_snapshotMagic, &data);
+    AppendNode(root, &data);
+    return WriteFileAtomically(path, data.data(), data.size());
+}
+
+//=========================================================================
+bool DataMapBinary::SyncFile (std::FILE * file) {
+    if (std::fflush(file) != 0)
+        return false;
+
+    #ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+    #else
+        return fsync(fileno(file)) == 0;
+    #endif
+}
+
+//=========================================================================
+bool DataMapBinary::WriteFileAtomically (const char * path, const std::uint8_t * data, std::size_t size) {
+    std::string tempPath;
+    std::FILE * file = OpenTempFile(path, &tempPath);
+    if (file == nullptr)
+        return false;
+
+    const bool ok = std::fwrite(data, 1, size, file) == size;
+    return CommitTempFile(file, tempPath.c_str(), path, ok);
+}
+
+} // namespace CSaruDataMap
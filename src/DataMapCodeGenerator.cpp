@@ -0,0 +1,228 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "exported/DataMapBinary.hpp"
+#include "exported/DataMapCodeGenerator.hpp"
+#include "exported/OffsetDataNode.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+static bool IsIdentifier (const std::string & str) {
+    if (str.empty() || (str[0] >= '0' && str[0] <= '9'))
+        return false;
+    for (char c : str) {
+        if (!(c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')))
+            return false;
+    }
+    return true;
+}
+
+//=========================================================================
+// RETURNS: false if nameSpace isn't identifiers joined by "::".
+static bool SplitNamespace (const char * nameSpace, std::vector<std::string> * outNames) {
+    outNames->clear();
+    if (nameSpace == nullptr || nameSpace[0] == '\0')
+        return true;
+
+    const std::string full(nameSpace);
+    std::size_t       begin = 0;
+    for (;;) {
+        const std::size_t end = full.find("::", begin);
+        outNames->push_back(full.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+        if (!IsIdentifier(outNames->back()))
+            return false;
+        if (end == std::string::npos)
+            return true;
+        begin = end + 2;
+    }
+}
+
+//=========================================================================
+static void AppendOpenNamespaces (const std::vector<std::string> & names, std::string * out) {
+    for (const std::string & name : names)
+        *out += "namespace " + name + " {\n";
+    if (!names.empty())
+        *out += "\n";
+}
+
+//=========================================================================
+static void AppendCloseNamespaces (const std::vector<std::string> & names, std::string * out) {
+    if (!names.empty())
+        *out += "\n";
+    for (std::size_t i = names.size();  i > 0;  --i)
+        *out += "} // namespace " + names[i - 1] + "\n";
+}
+
+//=========================================================================
+// writes data to path, unless path already holds exactly that.
+static bool WriteIfChanged (const char * path, const std::string & data) {
+    std::vector<std::uint8_t> existing;
+    if (
+        DataMapBinary::ReadFile(path, &existing) &&
+        existing.size() == data.size() &&
+        std::memcmp(existing.data(), data.data(), data.size()) == 0
+    ) {
+        return true;
+    }
+    return DataMapBinary::WriteFileAtomically(path, reinterpret_cast<const std::uint8_t *>(data.data()), data.size());
+}
+
+//=========================================================================
+bool DataMapCodeGenerator::GenerateHeader (const char * name, const char * nameSpace, std::string * out) {
+    std::vector<std::string> names;
+    if (!IsIdentifier(name) || !SplitNamespace(nameSpace, &names))
+        return false;
+
+    const std::string prefix(name);
+    out->assign("// Generated by CSaruDataMap::DataMapCodeGenerator.  Do not edit.\n\n#pragma once\n\n");
+    *out += "#include <csaru-datamap-cpp/OffsetDataMapReader.hpp>\n\n";
+    AppendOpenNamespaces(names, out);
+    *out += "// a Reader at the root of the embedded map.\n";
+    *out += "CSaruDataMap::OffsetDataMapReader Get" + prefix + "Reader (void);\n\n";
+    *out += "// for OffsetDataMapImage::ToDataNode().\n";
+    *out += "const CSaruDataMap::OffsetDataNode * Get" + prefix + "Nodes (void);\n";
+    *out += "const char * Get" + prefix + "Strings (void);\n";
+    AppendCloseNamespaces(names, out);
+    return true;
+}
+
+//=========================================================================
+bool DataMapCodeGenerator::GenerateSource (
+    const DataNode & root,
+    const char *     name,
+    const char *     nameSpace,
+    const char *     includeName,
+    std::string *    out
+) {
+    std::vector<std::string> names;
+    if (!IsIdentifier(name) || !SplitNamespace(nameSpace, &names))
+        return false;
+
+    std::vector<std::uint8_t> image;
+    OffsetDataMapImage::Build(root, &image);
+    const OffsetDataMapHeader * header  = OffsetDataMapImage::GetHeader(image.data());
+    const OffsetDataNode *      nodes   = OffsetDataMapImage::GetNodes(image.data());
+    const char *                strings = OffsetDataMapImage::GetStrings(image.data());
+
+    const std::string prefix(name);
+    char              line[128];
+
+    out->assign("// Generated by CSaruDataMap::DataMapCodeGenerator.  Do not edit.\n\n");
+    if (includeName != nullptr)
+        *out += std::string("#include \"") + includeName + "\"\n";
+    *out += "#include <csaru-datamap-cpp/OffsetDataMapReader.hpp>\n\n";
+    AppendOpenNamespaces(names, out);
+
+    *out += "namespace {\n\n";
+    *out += "static_assert(sizeof(CSaruDataMap::OffsetDataNode) == 24, \"OffsetDataNode has changed; regenerate this file.\");\n\n";
+
+    // name offset, name hash, first child, child count, value, type
+    std::snprintf(line, sizeof(line), "constexpr CSaruDataMap::OffsetDataNode s_nodes[%u] = {\n", unsigned(header->m_nodeCount));
+    *out += line;
+    for (std::uint32_t i = 0;  i < header->m_nodeCount;  ++i) {
+        const OffsetDataNode & node = nodes[i];
+        std::snprintf(
+            line,
+            sizeof(line),
+            "    {%uu, 0x%08Xu, %uu, %uu, 0x%08Xu, %u, {0, 0, 0}},\n",
+            unsigned(node.m_nameOffset),
+            unsigned(node.m_nameHash),
+            unsigned(node.m_childBegin),
+            unsigned(node.m_childCount),
+            unsigned(node.m_value),
+            unsigned(node.m_type)
+        );
+        *out += line;
+    }
+    *out += "};\n\n";
+
+    // one literal per string.  The literal's own null makes one more byte
+    //  than the table has.
+    std::snprintf(line, sizeof(line), "constexpr char s_strings[%u] =\n", unsigned(header->m_stringBytes + 1));
+    *out += line;
+    *out += "    \"";
+    for (std::uint32_t i = 0;  i < header->m_stringBytes;  ++i) {
+        const unsigned char c = static_cast<unsigned char>(strings[i]);
+        if (c == '\0') {
+            *out += i + 1 < header->m_stringBytes ? "\\000\"\n    \"" : "\\000\"";
+        }
+        else if (c == '"' || c == '\\') {
+            *out += '\\';
+            *out += char(c);
+        }
+        else if (c < ' ' || c > '~' || c == '?') {
+            // three digits, so a digit after it can't be taken as part of it.
+            std::snprintf(line, sizeof(line), "\\%03o", unsigned(c));
+            *out += line;
+        }
+        else {
+            *out += char(c);
+        }
+    }
+    *out += ";\n\n} // namespace\n\n";
+
+    *out += "CSaruDataMap::OffsetDataMapReader Get" + prefix + "Reader (void) {\n";
+    std::snprintf(
+        line,
+        sizeof(line),
+        "    return CSaruDataMap::OffsetDataMapReader(s_nodes, %uu, s_strings, %uu);\n",
+        unsigned(header->m_nodeCount),
+        unsigned(header->m_stringBytes)
+    );
+    *out += line;
+    *out += "}\n\n";
+    *out += "const CSaruDataMap::OffsetDataNode * Get" + prefix + "Nodes (void) {\n    return s_nodes;\n}\n\n";
+    *out += "const char * Get" + prefix + "Strings (void) {\n    return s_strings;\n}\n";
+
+    AppendCloseNamespaces(names, out);
+    return true;
+}
+
+//=========================================================================
+bool DataMapCodeGenerator::WriteFiles (
+    const DataNode & root,
+    const char *     name,
+    const char *     nameSpace,
+    const char *     headerPath,
+    const char *     sourcePath
+) {
+    const char * includeName = headerPath;
+    for (const char * c = headerPath;  *c;  ++c) {
+        if (*c == '/' || *c == '\\')
+            includeName = c + 1;
+    }
+
+    std::string header;
+    std::string source;
+    return
+        GenerateHeader(name, nameSpace, &header) &&
+        GenerateSource(root, name, nameSpace, includeName, &source) &&
+        WriteIfChanged(headerPath, header) &&
+        WriteIfChanged(sourcePath, source);
+}
+
+} // namespace CSaruDataMap
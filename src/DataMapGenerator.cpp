@@ -0,0 +1,174 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#include "exported/DataMapGenerator.hpp"
+
+#if CSARU_DATAMAP_HAS_COROUTINES
+
+#include <cstdio>
+#include <cstring>
+
+#include "exported/DataMapBinary.hpp"
+
+namespace CSaruDataMap {
+
+// how much of a streamed file is read at a time, at least.
+static const std::size_t s_streamReadSize = 64 * 1024;
+
+// enough for a snapshot's magic and any root's header.
+static const std::size_t s_streamHeaderSize = 64;
+
+//=========================================================================
+static DataMapGenerator<DataNode> StreamSnapshotElementsFrom (const char * path, bool * outComplete) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path, "rb"), &std::fclose);
+    if (!file)
+        co_return;
+
+    // [begin, end) of buffer is read but not yet parsed.
+    std::vector<std::uint8_t> buffer(s_streamReadSize);
+    std::size_t               begin = 0;
+    std::size_t               end   = 0;
+    bool                      atEnd = false;
+
+    // RETURNS: false if there's nothing more to read.
+    auto fill = [&]() -> bool {
+        if (atEnd)
+            return false;
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end  -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size())
+            buffer.resize(buffer.size() * 2);
+
+        const std::size_t want = buffer.size() - end;
+        const std::size_t read = std::fread(buffer.data() + end, 1, want, file.get());
+        end  += read;
+        atEnd = read < want;
+        return read > 0;
+    };
+
+    // the magic, then the root up to its children.
+    while (end < s_streamHeaderSize && fill())
+        ;
+    if (end < 4 || DataMapBinary::ReadUint32(buffer.data()) != DataMapBinary::s_snapshotMagic)
+        co_return;
+
+    std::size_t pos = 4;
+    if (pos >= end)
+        co_return;
+    const DataNode::Type type = DataNode::Type(buffer[pos++]);
+    if (type != DataNode::Type::Object && type != DataNode::Type::Array)
+        co_return;
+
+    std::uint64_t nameLength = 0;
+    std::size_t   read       = DataMapBinary::ReadVarint(buffer.data() + pos, end - pos, &nameLength);
+    if (read == 0 || nameLength >= DataNode::s_nameSize || nameLength > end - pos - read)
+        co_return;
+    pos += read + std::size_t(nameLength);
+
+    std::uint64_t childCount = 0;
+    read = DataMapBinary::ReadVarint(buffer.data() + pos, end - pos, &childCount);
+    if (read == 0)
+        co_return;
+    begin = pos + read;
+
+    DataNode element;
+    bool     truncated;
+    for (std::uint64_t i = 0;  i < childCount;  ++i) {
+        // a child cut off by the end of the buffer needs more of the file;
+        //  one that's malformed never will, so that ends the stream.
+        while ((read = DataMapBinary::ReadNode(buffer.data() + begin, end - begin, &element, &truncated)) == 0) {
+            if (!truncated || !fill())
+                co_return;
+        }
+        begin += read;
+        co_yield element;
+    }
+
+    // anything after the root means the file isn't what it claims to be.
+    if (begin == end && !fill())
+        *outComplete = true;
+}
+
+//=========================================================================
+std::string DataMapVisit::GetPath (void) const {
+    std::string path;
+    for (std::size_t i = 0;  i < m_indices->size();  ++i) {
+        const DataNode * parent = (*m_ancestors)[i];
+        const int        index  = (*m_indices)[i];
+        if (parent->GetType() == DataNode::Type::Array) {
+            path += '[';
+            path += std::to_string(index);
+            path += ']';
+        }
+        else {
+            if (!path.empty())
+                path += '.';
+            path += parent->GetChildFast(index)->GetName();
+        }
+    }
+    return path;
+}
+
+//=========================================================================
+DataMapGenerator<DataNode> StreamSnapshotElements (const char * path, bool * outComplete) {
+    // set here, since the coroutine doesn't start until it's first resumed.
+    *outComplete = false;
+    return StreamSnapshotElementsFrom(path, outComplete);
+}
+
+//=========================================================================
+DataMapGenerator<DataMapVisit> Traverse (const DataNode & root) {
+    std::vector<const DataNode *> ancestors;
+    std::vector<int>              indices;
+    DataMapVisit                  visit{&root, &ancestors, &indices, false};
+
+    for (;;) {
+        visit.m_skipChildren = false;
+        co_yield visit;
+
+        const DataNode * node = visit.m_node;
+        if (!visit.m_skipChildren && node->IsContainerType() && node->GetChildCount()) {
+            ancestors.push_back(node);
+            indices.push_back(0);
+            visit.m_node = node->GetChildFast(0);
+            continue;
+        }
+
+        // on to the next sibling, or the nearest ancestor's.
+        for (;;) {
+            if (ancestors.empty())
+                co_return;
+            if (++indices.back() < ancestors.back()->GetChildCount())
+                break;
+            ancestors.pop_back();
+            indices.pop_back();
+        }
+        visit.m_node = ancestors.back()->GetChildFast(indices.back());
+    }
+}
+
+} // namespace CSaruDataMap
+
+#endif // CSARU_DATAMAP_HAS_COROUTINES
@@ -0,0 +1,461 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "exported/DataMapBinary.hpp"
+#include "exported/DataMapJournal.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// FNV-1a over a record's payload.
+static std::uint32_t ChecksumBytes (const std::uint8_t * data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0;  i < size;  ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+//=========================================================================
+// gives to from's name, type, and value, but leaves its children alone.
+static void CopyNameAndValue (const DataNode & from, DataNode * to) {
+    to->SetName(from.GetName());
+    switch (from.GetType()) {
+        case DataNode::Type::Bool:   to->SetBool(from.GetBool());     break;
+        case DataNode::Type::Int:    to->SetInt(from.GetInt());       break;
+        case DataNode::Type::Float:  to->SetFloat(from.GetFloat());   break;
+        case DataNode::Type::String: to->SetString(from.GetString()); break;
+        default:                     to->SetType(from.GetType());     break;
+    }
+}
+
+//=========================================================================
+DataMapJournal::DataMapJournal (void)
+    : m_root(nullptr)
+    , m_file(nullptr)
+    , m_generation(0)
+    , m_snapshotGeneration(0)
+    , m_recordStart(0)
+    , m_committedSize(0)
+    , m_inTransaction(false)
+    , m_autoFlushBytes(s_defaultAutoFlushBytes)
+    , m_hasPending(false)
+    , m_pendingKind(RecordKind::Node)
+    , m_pendingNode(nullptr)
+    , m_pendingIndex(-1)
+    , m_pendingKeepChildren(false)
+    , m_compacting(false)
+    , m_compactionOk(true)
+{}
+
+//=========================================================================
+DataMapJournal::~DataMapJournal () {
+    Close();
+}
+
+//=========================================================================
+bool DataMapJournal::ApplyRecord (const std::uint8_t * data, std::size_t size) {
+    if (size < 1)
+        return false;
+    const RecordKind kind = RecordKind(data[0]);
+    std::size_t pos = 1;
+
+    // walk the path
+    std::uint64_t pathLength = 0;
+    std::size_t   read       = DataMapBinary::ReadVarint(data + pos, size - pos, &pathLength);
+    if (read == 0)
+        return false;
+    pos += read;
+
+    DataNode * node = m_root;
+    for (std::uint64_t i = 0;  i < pathLength;  ++i) {
+        std::uint64_t index = 0;
+        read = DataMapBinary::ReadVarint(data + pos, size - pos, &index);
+        if (read == 0 || index >= std::uint64_t(node->GetChildCount()))
+            return false;
+        pos += read;
+        node = node->GetChildFast(int(index));
+    }
+
+    std::uint64_t index   = 0;
+    std::uint64_t toIndex = 0;
+    switch (kind) {
+        case RecordKind::Node: {
+            if (size - pos < 1)
+                return false;
+            const bool keepChildren = data[pos++] != 0;
+            if (!keepChildren)
+                return DataMapBinary::ReadNode(data + pos, size - pos, node) == size - pos;
+
+            DataNode value;
+            if (DataMapBinary::ReadNode(data + pos, size - pos, &value) != size - pos)
+                return false;
+            CopyNameAndValue(value, node);
+        } return true;
+
+        case RecordKind::Insert: {
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &index);
+            if (read == 0 || index > std::uint64_t(node->GetChildCount()))
+                return false;
+            pos += read;
+
+            if (!node->IsContainerType())
+                node->SetType(DataNode::Type::Object);
+            DataNode * child = node->InsertNewChild(int(index));
+            return DataMapBinary::ReadNode(data + pos, size - pos, child) == size - pos;
+        }
+
+        case RecordKind::Delete: {
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &index);
+            if (read == 0 || index >= std::uint64_t(node->GetChildCount()))
+                return false;
+            node->DeleteChild(int(index));
+        } return true;
+
+        case RecordKind::Move: {
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &index);
+            if (read == 0)
+                return false;
+            pos += read;
+            read = DataMapBinary::ReadVarint(data + pos, size - pos, &toIndex);
+            const std::uint64_t childCount = std::uint64_t(node->GetChildCount());
+            if (read == 0 || index >= childCount || toIndex >= childCount)
+                return false;
+            node->MoveChild(int(index), int(toIndex));
+        } return true;
+    }
+
+    return false;
+}
+
+//=========================================================================
+void DataMapJournal::AutoFlush (void) {
+    if (m_autoFlushBytes && !m_inTransaction && m_buffer.size() >= m_autoFlushBytes)
+        Flush();
+}
+
+//=========================================================================
+void DataMapJournal::BeginRecord (RecordKind kind, const DataNode * node) {
+    // length and checksum go in front, once the payload is done
+    m_recordStart = m_buffer.size();
+    m_buffer.resize(m_recordStart + 8);
+    m_buffer.push_back(std::uint8_t(kind));
+
+    m_path.clear();
+    for (;  node != m_root;  node = node->GetParent())
+        m_path.push_back(node->GetIndexInParent());
+    DataMapBinary::AppendVarint(m_path.size(), &m_buffer);
+    for (std::vector<int>::reverse_iterator it = m_path.rbegin();  it != m_path.rend();  ++it)
+        DataMapBinary::AppendVarint(std::uint64_t(*it), &m_buffer);
+}
+
+//=========================================================================
+bool DataMapJournal::Close (void) {
+    bool ok = true;
+    if (m_file) {
+        ok = Flush();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    ok = WaitForCompaction() && ok;
+
+    m_buffer.clear();
+    m_committedSize = 0;
+    m_inTransaction = false;
+    m_hasPending    = false;
+    m_root          = nullptr;
+    return ok;
+}
+
+//=========================================================================
+void DataMapJournal::EndRecord (void) {
+    const std::size_t payloadSize = m_buffer.size() - m_recordStart - 8;
+    std::uint8_t * header = m_buffer.data() + m_recordStart;
+
+    std::vector<std::uint8_t> scratch;
+    scratch.reserve(8);
+    DataMapBinary::AppendUint32(std::uint32_t(payloadSize), &scratch);
+    DataMapBinary::AppendUint32(ChecksumBytes(header + 8, payloadSize), &scratch);
+    std::memcpy(header, scratch.data(), 8);
+}
+
+//=========================================================================
+bool DataMapJournal::Flush (void) {
+    if (m_file == nullptr)
+        return false;
+
+    RecordPending();
+
+    const std::size_t flushable = m_inTransaction ? m_committedSize : m_buffer.size();
+    if (flushable == 0)
+        return true;
+
+    bool ok = std::fwrite(m_buffer.data(), 1, flushable, m_file) == flushable;
+    ok = DataMapBinary::SyncFile(m_file) && ok;
+
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + flushable);
+    m_committedSize -= std::min(m_committedSize, flushable);
+    return ok;
+}
+
+//=========================================================================
+std::string DataMapJournal::GetFilePath (const char * kind, std::uint64_t generation) const {
+    return m_pathPrefix + "." + kind + "." + std::to_string(generation);
+}
+
+//=========================================================================
+bool DataMapJournal::Open (const char * pathPrefix, DataNode * root) {
+    Close();
+    m_pathPrefix = pathPrefix;
+
+    std::vector<std::uint8_t> data;
+    m_snapshotGeneration = 0;
+    if (DataMapBinary::ReadFile((m_pathPrefix + ".current").c_str(), &data)) {
+        data.push_back('\0');
+        m_snapshotGeneration = std::strtoull(reinterpret_cast<const char *>(data.data()), nullptr, 10);
+    }
+
+    root->DeleteAllChildren();
+    root->SetType(DataNode::Type::Object);
+    if (m_snapshotGeneration > 0 && !DataMapBinary::LoadSnapshot(GetFilePath("snapshot", m_snapshotGeneration).c_str(), root))
+        return false;
+    m_root = root;
+
+    // every journal from the snapshot's on, in order.  Only the last can have
+    //  been cut short by a crash.
+    m_generation = m_snapshotGeneration;
+    bool isNew   = true;
+    for (std::uint64_t generation = m_snapshotGeneration;  ;  ++generation) {
+        const std::string path = GetFilePath("journal", generation);
+        if (!DataMapBinary::ReadFile(path.c_str(), &data))
+            break;
+
+        m_generation = generation;
+        isNew        = false;
+
+        const std::size_t valid = Replay(data.data(), data.size());
+        if (valid < data.size()) {
+            // drop the torn tail so new records aren't appended after it.
+            std::vector<std::uint8_t> header;
+            DataMapBinary::AppendUint32(s_journalMagic, &header);
+            const bool ok = valid >= 4
+                ? DataMapBinary::WriteFileAtomically(path.c_str(), data.data(), valid)
+                : DataMapBinary::WriteFileAtomically(path.c_str(), header.data(), header.size());
+            if (!ok) {
+                m_root = nullptr;
+                return false;
+            }
+        }
+    }
+
+    if (!OpenJournalFile(isNew)) {
+        m_root = nullptr;
+        return false;
+    }
+    return true;
+}
+
+//=========================================================================
+bool DataMapJournal::OpenJournalFile (bool isNew) {
+    m_file = std::fopen(GetFilePath("journal", m_generation).c_str(), isNew ? "wb" : "ab");
+    if (m_file == nullptr)
+        return false;
+    if (!isNew)
+        return true;
+
+    std::vector<std::uint8_t> header;
+    DataMapBinary::AppendUint32(s_journalMagic, &header);
+    if (std::fwrite(header.data(), 1, header.size(), m_file) != header.size() || !DataMapBinary::SyncFile(m_file)) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+//=========================================================================
+void DataMapJournal::RecordPending (void) {
+    if (!m_hasPending)
+        return;
+    m_hasPending = false;
+
+    if (m_pendingKind == RecordKind::Node) {
+        BeginRecord(RecordKind::Node, m_pendingNode);
+        m_buffer.push_back(m_pendingKeepChildren ? 1 : 0);
+        DataMapBinary::AppendNode(*m_pendingNode, &m_buffer, !m_pendingKeepChildren);
+    } else {
+        BeginRecord(RecordKind::Insert, m_pendingNode);
+        DataMapBinary::AppendVarint(std::uint64_t(m_pendingIndex), &m_buffer);
+        DataMapBinary::AppendNode(*m_pendingNode->GetChildFast(m_pendingIndex), &m_buffer);
+    }
+    EndRecord();
+}
+
+//=========================================================================
+std::size_t DataMapJournal::Replay (const std::uint8_t * data, std::size_t size) {
+    if (size < 4 || DataMapBinary::ReadUint32(data) != s_journalMagic)
+        return 0;
+
+    std::size_t pos = 4;
+    while (size - pos >= 8) {
+        const std::uint32_t payloadSize = DataMapBinary::ReadUint32(data + pos);
+        const std::uint32_t checksum    = DataMapBinary::ReadUint32(data + pos + 4);
+        if (payloadSize > size - pos - 8 || ChecksumBytes(data + pos + 8, payloadSize) != checksum)
+            break;
+        if (!ApplyRecord(data + pos + 8, payloadSize))
+            break;
+        pos += 8 + payloadSize;
+    }
+    return pos;
+}
+
+//=========================================================================
+bool DataMapJournal::StartCompaction (void) {
+    if (m_file == nullptr || m_inTransaction || m_compacting.load())
+        return false;
+    if (m_compactor.joinable())
+        m_compactor.join();
+    if (!Flush())
+        return false;
+
+    // the new journal starts from exactly what's being copied.
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_compactionCopy.reset(new DataNode(*m_root));
+    ++m_generation;
+    if (!OpenJournalFile(true))
+        return false;
+
+    m_compacting.store(true);
+    const std::uint64_t generation    = m_generation;
+    const std::uint64_t oldSnapshot   = m_snapshotGeneration;
+    m_compactor = std::thread([this, generation, oldSnapshot] () {
+        bool ok = DataMapBinary::SaveSnapshot(GetFilePath("snapshot", generation).c_str(), *m_compactionCopy);
+        if (ok) {
+            const std::string text = std::to_string(generation);
+            ok = DataMapBinary::WriteFileAtomically(
+                (m_pathPrefix + ".current").c_str(),
+                reinterpret_cast<const std::uint8_t *>(text.data()),
+                text.size()
+            );
+        }
+
+        // everything before the new snapshot is now redundant.
+        if (ok) {
+            if (oldSnapshot > 0)
+                std::remove(GetFilePath("snapshot", oldSnapshot).c_str());
+            for (std::uint64_t old = oldSnapshot;  old < generation;  ++old)
+                std::remove(GetFilePath("journal", old).c_str());
+            m_snapshotGeneration = generation;
+        }
+
+        m_compactionCopy.reset();
+        m_compactionOk = ok;
+        m_compacting.store(false);
+    });
+    return true;
+}
+
+//=========================================================================
+bool DataMapJournal::WaitForCompaction (void) {
+    if (m_compactor.joinable())
+        m_compactor.join();
+    return m_compactionOk;
+}
+
+//=========================================================================
+void DataMapJournal::BeforeNodeChange (DataNode * node, bool keepChildren) {
+    if (m_file == nullptr)
+        return;
+    RecordPending();
+    AutoFlush();
+
+    m_hasPending          = true;
+    m_pendingKind         = RecordKind::Node;
+    m_pendingNode         = node;
+    m_pendingKeepChildren = keepChildren;
+}
+
+//=========================================================================
+void DataMapJournal::BeforeInsert (DataNode * parent, int index) {
+    if (m_file == nullptr)
+        return;
+    RecordPending();
+    AutoFlush();
+
+    m_hasPending   = true;
+    m_pendingKind  = RecordKind::Insert;
+    m_pendingNode  = parent;
+    m_pendingIndex = index;
+}
+
+//=========================================================================
+void DataMapJournal::BeforeDelete (DataNode * parent, int index) {
+    if (m_file == nullptr)
+        return;
+    RecordPending();
+    AutoFlush();
+
+    BeginRecord(RecordKind::Delete, parent);
+    DataMapBinary::AppendVarint(std::uint64_t(index), &m_buffer);
+    EndRecord();
+}
+
+//=========================================================================
+void DataMapJournal::BeforeMove (DataNode * parent, int fromIndex, int toIndex) {
+    if (m_file == nullptr)
+        return;
+    RecordPending();
+    AutoFlush();
+
+    BeginRecord(RecordKind::Move, parent);
+    DataMapBinary::AppendVarint(std::uint64_t(fromIndex), &m_buffer);
+    DataMapBinary::AppendVarint(std::uint64_t(toIndex), &m_buffer);
+    EndRecord();
+}
+
+//=========================================================================
+void DataMapJournal::OnTransactionBegin (void) {
+    RecordPending();
+    m_inTransaction = true;
+    m_committedSize = m_buffer.size();
+}
+
+//=========================================================================
+void DataMapJournal::OnTransactionCommit (void) {
+    RecordPending();
+    m_inTransaction = false;
+    m_committedSize = m_buffer.size();
+    AutoFlush();
+}
+
+//=========================================================================
+void DataMapJournal::OnTransactionRollback (void) {
+    // the last change's node may be gone with the rest.
+    m_hasPending    = false;
+    m_inTransaction = false;
+    m_buffer.resize(m_committedSize);
+}
+
+} // namespace CSaruDataMap
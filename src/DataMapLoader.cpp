@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#include <algorithm>
+#include <cstdio>
+
+#include "exported/DataMapLoader.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+DataMapLoader::DataMapLoader (WorkStealingPool * parsePool)
+    : m_pool(parsePool)
+    , m_stopping(false)
+{
+    m_ioThread = std::thread(&DataMapLoader::IoMain, this);
+}
+
+//=========================================================================
+DataMapLoader::~DataMapLoader () {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_ioThread.join();
+}
+
+//=========================================================================
+void DataMapLoader::IoMain (void) {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+            if (m_requests.empty())
+                return;
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        // shared, since pool tasks have to be copyable.
+        std::shared_ptr<std::vector<std::uint8_t>> data(new std::vector<std::uint8_t>);
+        const bool                                 read = ReadWholeFile(request.m_path.c_str(), data.get());
+
+        Parser   parser   = std::move(request.m_parser);
+        Callback callback = std::move(request.m_callback);
+        m_pool->Submit([read, data, parser, callback]() {
+            std::unique_ptr<DataNode> root;
+            if (read) {
+                root.reset(new DataNode);
+                if (!parser(data->data(), data->size(), root.get()))
+                    root.reset();
+            }
+            callback(std::move(root));
+        });
+    }
+}
+
+//=========================================================================
+std::future<std::unique_ptr<DataNode>> DataMapLoader::Load (const char * path, const Parser & parser) {
+    std::shared_ptr<std::promise<std::unique_ptr<DataNode>>> promise(new std::promise<std::unique_ptr<DataNode>>);
+    std::future<std::unique_ptr<DataNode>>                   future = promise->get_future();
+    Load(path, parser, [promise](std::unique_ptr<DataNode> root) {
+        promise->set_value(std::move(root));
+    });
+    return future;
+}
+
+//=========================================================================
+void DataMapLoader::Load (const char * path, const Parser & parser, const Callback & done) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(Request{path, parser, done});
+    }
+    m_wake.notify_one();
+}
+
+//=========================================================================
+bool DataMapLoader::ReadWholeFile (const char * path, std::vector<std::uint8_t> * outData) {
+    std::FILE * file = std::fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    // reads go straight into outData, s_readSize at a time, rather than
+    //  through stdio's small buffer.
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    // sized up front where the file's size is known; grown if it's bigger.
+    outData->clear();
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        const long size = std::ftell(file);
+        if (size > 0)
+            outData->resize(std::size_t(size));
+        std::fseek(file, 0, SEEK_SET);
+    }
+
+    std::size_t used = 0;
+    for (;;) {
+        if (used == outData->size()) {
+            // full; only grow if the file really goes on.
+            std::uint8_t probe;
+            if (std::fread(&probe, 1, 1, file) == 0)
+                break;
+            outData->resize(used + s_readSize);
+            (*outData)[used++] = probe;
+        }
+        const std::size_t want = std::min(std::size_t(s_readSize), outData->size() - used);
+        const std::size_t read = std::fread(outData->data() + used, 1, want, file);
+        used += read;
+        if (read < want)
+            break;
+    }
+    outData->resize(used);
+
+    const bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,390 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+#include "exported/DataKey.hpp"
+#include "exported/DataMapOverlay.hpp"
+
+#define DATAMAPOVERLAY_BASIC_SAFETY_CHECKS 1
+#define DATAMAPOVERLAY_EXTRA_SAFETY_CHECKS 1
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// nulls every node which a higher layer's node shadows.
+// RETURNS: the topmost layer left with a node, or -1 if there is none.
+static int ShadowLayers (const DataNode ** nodes, int layerCount) {
+    int top = layerCount - 1;
+    while (top >= 0 && nodes[top] == nullptr)
+        --top;
+    if (top < 0)
+        return -1;
+
+    // Objects merge down until something that isn't one.
+    bool merging = nodes[top]->GetType() == DataNode::Type::Object;
+    for (int layer = top - 1;  layer >= 0;  --layer) {
+        if (nodes[layer] == nullptr)
+            continue;
+        if (merging && nodes[layer]->GetType() != DataNode::Type::Object)
+            merging = false;
+        if (!merging)
+            nodes[layer] = nullptr;
+    }
+    return top;
+}
+
+//=========================================================================
+// keys a table of children by name, using the hash each node already has.
+struct ChildNameHash {
+    std::size_t operator() (const DataNode * node) const { return node->GetNameHash(); }
+};
+
+struct ChildNameEqual {
+    bool operator() (const DataNode * a, const DataNode * b) const {
+        return a->GetNameHash() == b->GetNameHash() && std::strcmp(a->GetName(), b->GetName()) == 0;
+    }
+};
+
+typedef std::unordered_map<const DataNode *, int, ChildNameHash, ChildNameEqual> ChildIndexMap;
+
+//=========================================================================
+// RETURNS: how many layers still have a node.
+static int CountLayers (const DataNode * const * nodes, int layerCount) {
+    int count = 0;
+    for (int layer = 0;  layer < layerCount;  ++layer)
+        count += nodes[layer] ? 1 : 0;
+    return count;
+}
+
+//=========================================================================
+int DataMapOverlay::AddLayer (const DataNode * root) {
+    if (int(m_layers.size()) >= s_maxLayers)
+        return -1;
+
+    m_layers.push_back(root);
+    return int(m_layers.size()) - 1;
+}
+
+//=========================================================================
+void DataMapOverlay::Clear (void) {
+    m_layers.clear();
+}
+
+//=========================================================================
+void DataMapOverlay::Flatten (DataNode * outRoot) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(outRoot && "DataMapOverlay::Flatten() called, but outRoot == nullptr.");
+    #endif
+
+    const DataNode * nodes[s_maxLayers] = {};
+    const int layerCount = int(m_layers.size());
+    for (int layer = 0;  layer < layerCount;  ++layer)
+        nodes[layer] = m_layers[layer];
+
+    if (ShadowLayers(nodes, layerCount) < 0) {
+        outRoot->DeleteAllChildren();
+        outRoot->SetType(DataNode::Type::Null);
+        return;
+    }
+    FlattenNode(nodes, outRoot);
+}
+
+//=========================================================================
+void DataMapOverlay::FlattenNode (const DataNode * const * nodes, DataNode * outNode) const {
+    const int layerCount = int(m_layers.size());
+    int top = layerCount - 1;
+    while (nodes[top] == nullptr)
+        --top;
+
+    // nothing to merge; copy it all, keeping outNode's name.
+    if (CountLayers(nodes, layerCount) == 1) {
+        char name[DataNode::s_nameSize];
+        std::memcpy(name, outNode->GetName(), sizeof(name));
+        *outNode = *nodes[top];
+        outNode->SetName(name);
+        return;
+    }
+
+    outNode->DeleteAllChildren();
+    outNode->SetType(DataNode::Type::Object);
+
+    std::vector<MergedChild> children;
+    MergeChildren(nodes, layerCount, &children);
+    outNode->ReserveChildren(int(children.size()));
+
+    for (MergedChild & child : children) {
+        // named before shadowing, which may null the lowest layer's node.
+        DataNode * outChild = outNode->AppendNewChild();
+        outChild->SetName(child.m_nodes[child.m_layer]->GetName());
+        ShadowLayers(child.m_nodes, layerCount);
+        FlattenNode(child.m_nodes, outChild);
+    }
+}
+
+//=========================================================================
+void DataMapOverlay::MergeChildren (
+    const DataNode * const *   nodes,
+    int                        layerCount,
+    std::vector<MergedChild> * outChildren
+) {
+    outChildren->clear();
+
+    int childCount = 0;
+    for (int layer = 0;  layer < layerCount;  ++layer)
+        childCount += nodes[layer] ? nodes[layer]->GetChildCount() : 0;
+
+    // name -> index in outChildren.
+    ChildIndexMap indexOfName;
+    indexOfName.reserve(std::size_t(childCount));
+    outChildren->reserve(std::size_t(childCount));
+
+    for (int layer = 0;  layer < layerCount;  ++layer) {
+        if (nodes[layer] == nullptr)
+            continue;
+
+        const int layerChildCount = nodes[layer]->GetChildCount();
+        for (int i = 0;  i < layerChildCount;  ++i) {
+            const DataNode * child = nodes[layer]->GetChildFast(i);
+            const std::pair<ChildIndexMap::iterator, bool> found = indexOfName.emplace(child, int(outChildren->size()));
+            if (found.second) {
+                MergedChild merged = {};
+                merged.m_layer = layer;
+                outChildren->push_back(merged);
+            }
+
+            // a layer's later duplicates of a name are shadowed by its first.
+            MergedChild & merged = (*outChildren)[std::size_t(found.first->second)];
+            if (merged.m_nodes[layer] == nullptr)
+                merged.m_nodes[layer] = child;
+        }
+    }
+}
+
+//=========================================================================
+void DataMapOverlay::SetLayer (int layer, const DataNode * root) {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(layer >= 0 && layer < int(m_layers.size()) && "DataMapOverlay::SetLayer() called with an invalid layer.");
+    #endif
+
+    m_layers[layer] = root;
+}
+
+//=========================================================================
+DataMapOverlayReader::DataMapOverlayReader (const DataMapOverlay * overlay)
+    : m_overlay(overlay)
+{
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(overlay && "DataMapOverlayReader constructed with overlay == nullptr.");
+    #endif
+
+    for (int layer = 0;  layer < DataMapOverlay::s_maxLayers;  ++layer)
+        m_frame.m_nodes[layer] = layer < overlay->GetLayerCount() ? overlay->GetLayer(layer) : nullptr;
+    m_frame.m_top      = ShadowLayers(m_frame.m_nodes, overlay->GetLayerCount());
+    m_frame.m_isMerged = false;
+}
+
+//=========================================================================
+int DataMapOverlayReader::GetChildCount (void) const {
+    if (m_frame.m_top < 0)
+        return 0;
+
+    if (CountLayers(m_frame.m_nodes, m_overlay->GetLayerCount()) == 1)
+        return m_frame.m_nodes[m_frame.m_top]->GetChildCount();
+
+    return int(GetMergedChildren().size());
+}
+
+//=========================================================================
+const std::vector<DataMapOverlay::MergedChild> & DataMapOverlayReader::GetMergedChildren (void) const {
+    if (!m_frame.m_isMerged) {
+        DataMapOverlay::MergeChildren(m_frame.m_nodes, m_overlay->GetLayerCount(), &m_frame.m_merged);
+        m_frame.m_isMerged = true;
+    }
+    return m_frame.m_merged;
+}
+
+//=========================================================================
+DataMapOverlayReader & DataMapOverlayReader::PopNode (void) {
+    if (m_frameStack.empty()) {
+        m_frame.m_top = -1;
+        return *this;
+    }
+
+    m_frame = std::move(m_frameStack.back());
+    m_frameStack.pop_back();
+    return *this;
+}
+
+//=========================================================================
+void DataMapOverlayReader::PushFrame (void) {
+    m_frameStack.push_back(std::move(m_frame));
+    m_frame.m_merged.clear();
+    m_frame.m_isMerged = false;
+}
+
+//=========================================================================
+DataMapOverlayReader & DataMapOverlayReader::ToChild (int index) {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ToChild(int) called, but the Reader is invalid.");
+    #endif
+
+    const int layerCount = m_overlay->GetLayerCount();
+    if (CountLayers(m_frame.m_nodes, layerCount) == 1) {
+        const int        top   = m_frame.m_top;
+        const DataNode * child = m_frame.m_nodes[top]->GetChildSafe(index);
+        PushFrame();
+        m_frame.m_nodes[top] = child;
+        m_frame.m_top        = child ? top : -1;
+        return *this;
+    }
+
+    // copied out, since pushing the frame moves the list.
+    const std::vector<DataMapOverlay::MergedChild> & children = GetMergedChildren();
+    if (index < 0 || index >= int(children.size())) {
+        PushFrame();
+        m_frame.m_top = -1;
+        return *this;
+    }
+    const DataMapOverlay::MergedChild child = children[std::size_t(index)];
+
+    PushFrame();
+    for (int l = 0;  l < layerCount;  ++l)
+        m_frame.m_nodes[l] = child.m_nodes[l];
+    m_frame.m_top = ShadowLayers(m_frame.m_nodes, layerCount);
+    return *this;
+}
+
+//=========================================================================
+DataMapOverlayReader & DataMapOverlayReader::ToChild (const char * name) {
+    return ToChild(DataKey::FromString(name));
+}
+
+//=========================================================================
+DataMapOverlayReader & DataMapOverlayReader::ToChild (const DataKey & key) {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ToChild(const DataKey &) called, but the Reader is invalid.");
+    #endif
+
+    PushFrame();
+
+    const int layerCount = m_overlay->GetLayerCount();
+    for (int layer = 0;  layer < layerCount;  ++layer) {
+        if (m_frame.m_nodes[layer])
+            m_frame.m_nodes[layer] = m_frame.m_nodes[layer]->GetChildByName(key);
+    }
+    m_frame.m_top = ShadowLayers(m_frame.m_nodes, layerCount);
+    return *this;
+}
+
+//=========================================================================
+const char * DataMapOverlayReader::ReadName (void) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ReadName() called, but the Reader is invalid.");
+    #endif
+
+    return GetCurrentNode()->GetName();
+}
+
+//=========================================================================
+bool DataMapOverlayReader::ReadBool (void) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ReadBool() called, but the Reader is invalid.");
+    #endif
+    #if DATAMAPOVERLAY_EXTRA_SAFETY_CHECKS
+        assert(
+            GetCurrentNode()->GetType() == DataNode::Type::Bool &&
+                "DataMapOverlayReader::ReadBool() called, but the node's type is not Type::Bool."
+        );
+    #endif
+
+    return GetCurrentNode()->GetBool();
+}
+
+//=========================================================================
+int DataMapOverlayReader::ReadInt (void) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ReadInt() called, but the Reader is invalid.");
+    #endif
+    #if DATAMAPOVERLAY_EXTRA_SAFETY_CHECKS
+        assert(
+            GetCurrentNode()->GetType() == DataNode::Type::Int &&
+                "DataMapOverlayReader::ReadInt() called, but the node's type is not Type::Int."
+        );
+    #endif
+
+    return GetCurrentNode()->GetInt();
+}
+
+//=========================================================================
+float DataMapOverlayReader::ReadFloat (void) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ReadFloat() called, but the Reader is invalid.");
+    #endif
+    #if DATAMAPOVERLAY_EXTRA_SAFETY_CHECKS
+        assert(
+            GetCurrentNode()->GetType() == DataNode::Type::Float &&
+                "DataMapOverlayReader::ReadFloat() called, but the node's type is not Type::Float."
+        );
+    #endif
+
+    return GetCurrentNode()->GetFloat();
+}
+
+//=========================================================================
+const char * DataMapOverlayReader::ReadString (void) const {
+    #if DATAMAPOVERLAY_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "DataMapOverlayReader::ReadString() called, but the Reader is invalid.");
+    #endif
+    #if DATAMAPOVERLAY_EXTRA_SAFETY_CHECKS
+        assert(
+            GetCurrentNode()->GetType() == DataNode::Type::String &&
+                "DataMapOverlayReader::ReadString() called, but the node's type is not Type::String."
+        );
+    #endif
+
+    return GetCurrentNode()->GetString();
+}
+
+//=========================================================================
+bool DataMapOverlayReader::ReadBoolSafe (bool * outBool) const {
+    return IsValid() && GetCurrentNode()->QueryBool(outBool);
+}
+
+//=========================================================================
+bool DataMapOverlayReader::ReadIntSafe (int * outInt) const {
+    return IsValid() && GetCurrentNode()->QueryInt(outInt);
+}
+
+//=========================================================================
+bool DataMapOverlayReader::ReadFloatSafe (float * outFloat) const {
+    return IsValid() && GetCurrentNode()->QueryFloat(outFloat);
+}
+
+//=========================================================================
+bool DataMapOverlayReader::ReadStringSafe (char * outString, int bufferSizeInElements) const {
+    return IsValid() && GetCurrentNode()->QueryString(outString, bufferSizeInElements);
+}
+
+} // namespace CSaruDataMap
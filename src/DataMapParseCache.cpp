@@ -0,0 +1,238 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#include <cstdio>
+#include <cstring>
+
+#include <sys/stat.h>
+
+#include "exported/DataMapBinary.hpp"
+#include "exported/DataMapParseCache.hpp"
+#include "exported/OffsetDataNode.hpp"
+
+namespace CSaruDataMap {
+
+// magic, size, modification time, content hash, image hash, path length.
+static const std::size_t s_keyBytes = 4 + 8 + 8 + 8 + 8 + 4;
+
+//=========================================================================
+static std::uint64_t HashContents (const std::uint8_t * data, std::size_t size) {
+    std::uint64_t hash = 0xCBF29CE484222325ull ^ size;
+    for (;;) {
+        std::uint64_t word = 0;
+        const std::size_t chunk = size < 8 ? size : 8;
+        if (chunk)
+            std::memcpy(&word, data, chunk);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+        if (chunk < 8)
+            break;
+        data += 8;
+        size -= 8;
+    }
+    // never 0, which means "not hashed".
+    return hash ? hash : 1;
+}
+
+//=========================================================================
+// the key, then the path, padded so that the image after it is aligned for
+//  reading in place.
+static std::size_t GetHeaderSize (std::size_t pathLength) {
+    return (s_keyBytes + pathLength + 7) & ~std::size_t(7);
+}
+
+//=========================================================================
+static void AppendUint64 (std::uint64_t value, std::vector<std::uint8_t> * out) {
+    DataMapBinary::AppendUint32(std::uint32_t(value), out);
+    DataMapBinary::AppendUint32(std::uint32_t(value >> 32), out);
+}
+
+//=========================================================================
+static std::uint64_t ReadUint64 (const std::uint8_t * data) {
+    return std::uint64_t(DataMapBinary::ReadUint32(data)) | (std::uint64_t(DataMapBinary::ReadUint32(data + 4)) << 32);
+}
+
+//=========================================================================
+DataMapParseCache::DataMapParseCache (const char * directory, const Parser & parser)
+    : m_directory(directory)
+    , m_parser(parser)
+    , m_verifyContents(true)
+    , m_hitCount(0)
+    , m_missCount(0)
+{}
+
+//=========================================================================
+bool DataMapParseCache::FindImage (Source * source, std::vector<std::uint8_t> * outImage) const {
+    std::vector<std::uint8_t> entry;
+    if (!DataMapBinary::ReadFile(GetEntryPath(source->m_path).c_str(), &entry))
+        return false;
+
+    // magic, size, time, content hash, image hash, path length
+    if (entry.size() < s_keyBytes || DataMapBinary::ReadUint32(entry.data()) != s_magic)
+        return false;
+
+    const std::uint32_t pathLength = DataMapBinary::ReadUint32(entry.data() + 36);
+    const std::size_t   headerSize = GetHeaderSize(pathLength);
+    if (
+        entry.size() < headerSize ||
+        ReadUint64(entry.data() + 4) != source->m_size ||
+        std::int64_t(ReadUint64(entry.data() + 12)) != source->m_modifiedTime ||
+        pathLength != source->m_path.size() ||
+        std::memcmp(entry.data() + s_keyBytes, source->m_path.data(), pathLength) != 0
+    ) {
+        return false;
+    }
+
+    if (m_verifyContents) {
+        if (!ReadSource(source) || ReadUint64(entry.data() + 20) != source->m_contentHash)
+            return false;
+    }
+
+    // a damaged or planted entry must not reach ToDataNode().
+    const std::uint8_t * image     = entry.data() + headerSize;
+    const std::size_t    imageSize = entry.size() - headerSize;
+    if (ReadUint64(entry.data() + 28) != HashContents(image, imageSize) || !OffsetDataMapImage::Validate(image, imageSize))
+        return false;
+
+    outImage->assign(entry.begin() + std::ptrdiff_t(headerSize), entry.end());
+    return true;
+}
+
+//=========================================================================
+void DataMapParseCache::Forget (const char * sourcePath) {
+    std::remove(GetEntryPath(sourcePath).c_str());
+}
+
+//=========================================================================
+std::string DataMapParseCache::GetEntryPath (const std::string & sourcePath) const {
+    // FNV-1a
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    for (char c : sourcePath)
+        hash = (hash ^ std::uint8_t(c)) * 0x100000001B3ull;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.dpc", static_cast<unsigned long long>(hash));
+    return m_directory + name;
+}
+
+//=========================================================================
+bool DataMapParseCache::Load (const char * sourcePath, DataNode * outRoot) {
+    Source                    source;
+    std::vector<std::uint8_t> image;
+    if (!StatSource(sourcePath, &source))
+        return false;
+
+    if (FindImage(&source, &image)) {
+        ++m_hitCount;
+        OffsetDataMapImage::ToDataNode(OffsetDataMapImage::GetNodes(image.data()), OffsetDataMapImage::GetStrings(image.data()), outRoot);
+        return true;
+    }
+
+    ++m_missCount;
+    return ParseSource(&source, outRoot, &image);
+}
+
+//=========================================================================
+bool DataMapParseCache::LoadImage (const char * sourcePath, std::vector<std::uint8_t> * outImage) {
+    Source source;
+    if (!StatSource(sourcePath, &source))
+        return false;
+
+    if (FindImage(&source, outImage)) {
+        ++m_hitCount;
+        return true;
+    }
+
+    ++m_missCount;
+    DataNode root;
+    return ParseSource(&source, &root, outImage);
+}
+
+//=========================================================================
+bool DataMapParseCache::ParseSource (Source * source, DataNode * outRoot, std::vector<std::uint8_t> * outImage) {
+    if (!ReadSource(source) || !m_parser(source->m_contents.data(), source->m_contents.size(), outRoot))
+        return false;
+
+    OffsetDataMapImage::Build(*outRoot, outImage);
+
+    const std::size_t         headerSize = GetHeaderSize(source->m_path.size());
+    std::vector<std::uint8_t> entry;
+    entry.reserve(headerSize + outImage->size());
+    DataMapBinary::AppendUint32(s_magic, &entry);
+    AppendUint64(source->m_size, &entry);
+    AppendUint64(std::uint64_t(source->m_modifiedTime), &entry);
+    AppendUint64(source->m_contentHash, &entry);
+    AppendUint64(HashContents(outImage->data(), outImage->size()), &entry);
+    DataMapBinary::AppendUint32(std::uint32_t(source->m_path.size()), &entry);
+    entry.insert(entry.end(), source->m_path.begin(), source->m_path.end());
+    entry.resize(headerSize, 0);
+    entry.insert(entry.end(), outImage->begin(), outImage->end());
+
+    // the load succeeded either way; a later one will just parse again.
+    DataMapBinary::WriteFileAtomically(GetEntryPath(source->m_path).c_str(), entry.data(), entry.size());
+    return true;
+}
+
+//=========================================================================
+bool DataMapParseCache::ReadSource (Source * source) const {
+    if (source->m_hasContents)
+        return true;
+
+    if (!DataMapBinary::ReadFile(source->m_path.c_str(), &source->m_contents))
+        return false;
+
+    // changed since it was stat()ed; the key would be wrong.
+    if (source->m_contents.size() != source->m_size)
+        return false;
+
+    source->m_contentHash = HashContents(source->m_contents.data(), source->m_contents.size());
+    source->m_hasContents = true;
+    return true;
+}
+
+//=========================================================================
+bool DataMapParseCache::StatSource (const char * path, Source * outSource) const {
+    outSource->m_path        = path;
+    outSource->m_contentHash = 0;
+    outSource->m_hasContents = false;
+
+    #ifdef _WIN32
+        struct _stat64 status;
+        if (_stat64(path, &status) != 0)
+            return false;
+        outSource->m_modifiedTime = std::int64_t(status.st_mtime) * 1000000000;
+    #else
+        struct stat status;
+        if (stat(path, &status) != 0)
+            return false;
+        #ifdef __APPLE__
+            outSource->m_modifiedTime = std::int64_t(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+        #else
+            outSource->m_modifiedTime = std::int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+        #endif
+    #endif
+
+    outSource->m_size = std::uint64_t(status.st_size);
+    return true;
+}
+
+} // namespace CSaruDataMap
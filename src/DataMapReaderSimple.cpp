@@ -18,7 +18,12 @@ freely, subject to the following restrictions:
 3. This notice may not be removed or altered from any source distribution.
 */
 
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
 #include "exported/DataMapReaderSimple.hpp"
+#include "exported/DataNode.hpp"
 
 namespace CSaruDataMap {
 
@@ -33,6 +38,46 @@ DataMapReaderSimple::DataMapReaderSimple (const DataMapReader & reader) :
 DataMapReaderSimple::~DataMapReaderSimple () {
 }
 
+//==============================================================================
+static void WriteDefault (const DataMapReaderSimple::Field & field) {
+
+    typedef DataMapReaderSimple::Field::Type FieldType;
+
+    switch (field.m_type) {
+        case FieldType::Bool:   *static_cast<bool *>(field.m_dest)  = field.m_default.m_bool;  break;
+        case FieldType::Int:    *static_cast<int *>(field.m_dest)   = field.m_default.m_int;   break;
+        case FieldType::Float:  *static_cast<float *>(field.m_dest) = field.m_default.m_float; break;
+        case FieldType::String: {
+            std::string * dest = static_cast<std::string *>(field.m_dest);
+            if (field.m_default.m_string)
+                *dest = field.m_default.m_string;
+            else
+                dest->clear();
+        } break;
+    }
+
+}
+
+//==============================================================================
+static bool ReadField (const DataMapReaderSimple::Field & field, const DataNode & node) {
+
+    typedef DataMapReaderSimple::Field::Type FieldType;
+
+    switch (field.m_type) {
+        case FieldType::Bool:   return node.QueryBool(static_cast<bool *>(field.m_dest));
+        case FieldType::Int:    return node.QueryInt(static_cast<int *>(field.m_dest));
+        case FieldType::Float:  return node.QueryFloat(static_cast<float *>(field.m_dest));
+        case FieldType::String:
+            if (node.GetType() != DataNode::Type::String)
+                return false;
+            *static_cast<std::string *>(field.m_dest) = node.GetString();
+            return true;
+    }
+
+    return false;
+
+}
+
 //==============================================================================
 bool DataMapReaderSimple::Bool (const char * name) const {
 
@@ -67,6 +112,32 @@ bool DataMapReaderSimple::Bool (const char * name, bool defaultValue) const {
 
 }
 
+//==============================================================================
+bool DataMapReaderSimple::Bool (const DataKey & key, bool defaultValue) const {
+
+    const DataNode * node = IsValid() ? m_reader.GetCurrentNode()->GetChildByName(key) : nullptr;
+
+    bool result;
+    if (node == nullptr || !node->QueryBool(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
+//==============================================================================
+bool DataMapReaderSimple::Bool (const DataPath & path, bool defaultValue) const {
+
+    const DataNode * node = IsValid() ? path.Resolve(m_reader.GetCurrentNode()) : nullptr;
+
+    bool result;
+    if (node == nullptr || !node->QueryBool(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
 //==============================================================================
 bool DataMapReaderSimple::EnterArray (const char * name) {
 
@@ -129,6 +200,32 @@ float DataMapReaderSimple::Float (const char * name, float defaultValue) const {
 
 }
 
+//==============================================================================
+float DataMapReaderSimple::Float (const DataKey & key, float defaultValue) const {
+
+    const DataNode * node = IsValid() ? m_reader.GetCurrentNode()->GetChildByName(key) : nullptr;
+
+    float result;
+    if (node == nullptr || !node->QueryFloat(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
+//==============================================================================
+float DataMapReaderSimple::Float (const DataPath & path, float defaultValue) const {
+
+    const DataNode * node = IsValid() ? path.Resolve(m_reader.GetCurrentNode()) : nullptr;
+
+    float result;
+    if (node == nullptr || !node->QueryFloat(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
 //==============================================================================
 int DataMapReaderSimple::Int (const char * name) const {
 
@@ -163,6 +260,95 @@ int DataMapReaderSimple::Int (const char * name, int defaultValue) const {
 
 }
 
+//==============================================================================
+int DataMapReaderSimple::Int (const DataKey & key, int defaultValue) const {
+
+    const DataNode * node = IsValid() ? m_reader.GetCurrentNode()->GetChildByName(key) : nullptr;
+
+    int result;
+    if (node == nullptr || !node->QueryInt(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
+//==============================================================================
+int DataMapReaderSimple::Int (const DataPath & path, int defaultValue) const {
+
+    const DataNode * node = IsValid() ? path.Resolve(m_reader.GetCurrentNode()) : nullptr;
+
+    int result;
+    if (node == nullptr || !node->QueryInt(&result))
+        result = defaultValue;
+
+    return result;
+
+}
+
+//==============================================================================
+int DataMapReaderSimple::ReadFields (Field * fields, int fieldCount) const {
+
+    for (int f = 0; f < fieldCount; ++f)
+        WriteDefault(fields[f]);
+
+    if (fieldCount <= 0 || !IsValid())
+        return 0;
+
+    // Open-addressed table from name hash to field index, at most half full.
+    //  -1 is an empty slot, and a field which has been filled is stored as
+    //  (-2 - index) so that it stops matching without breaking probe chains.
+    int tableSize = 16;
+    while (tableSize < fieldCount * 2)
+        tableSize *= 2;
+    const std::uint32_t mask = std::uint32_t(tableSize - 1);
+
+    int              stackTable[s_fieldTableStackSize];
+    std::vector<int> heapTable;
+    int *            table = stackTable;
+    if (tableSize > s_fieldTableStackSize) {
+        heapTable.resize(tableSize);
+        table = heapTable.data();
+    }
+    for (int slot = 0; slot < tableSize; ++slot)
+        table[slot] = -1;
+
+    for (int f = 0; f < fieldCount; ++f) {
+        std::uint32_t slot = fields[f].m_key.m_hash & mask;
+        while (table[slot] != -1)
+            slot = (slot + 1) & mask;
+        table[slot] = f;
+    }
+
+    const DataNode * node       = m_reader.GetCurrentNode();
+    const int        childCount = node->GetChildCount();
+    int              remaining  = fieldCount;
+    int              readCount  = 0;
+
+    for (int c = 0; c < childCount && remaining; ++c) {
+        const DataNode * child = node->GetChildSafe(c);
+        const std::uint32_t hash = child->GetNameHash();
+
+        for (std::uint32_t slot = hash & mask; table[slot] != -1; slot = (slot + 1) & mask) {
+            const int f = table[slot];
+            if (f < 0)
+                continue;
+
+            Field & field = fields[f];
+            if (field.m_key.m_hash != hash || !field.m_key.MatchesName(child->GetName()))
+                continue;
+
+            if (ReadField(field, *child))
+                ++readCount;
+            table[slot] = -2 - f;
+            --remaining;
+        }
+    }
+
+    return readCount;
+
+}
+
 //==============================================================================
 bool DataMapReaderSimple::IsValid () const {
 
@@ -210,6 +396,36 @@ std::string DataMapReaderSimple::String (
 
 }
 
+//==============================================================================
+std::string DataMapReaderSimple::String (
+    const DataKey & key,
+    const std::string & defaultValue
+) const {
+
+    const DataNode * node = IsValid() ? m_reader.GetCurrentNode()->GetChildByName(key) : nullptr;
+
+    if (node == nullptr || node->GetType() != DataNode::Type::String)
+        return defaultValue;
+
+    return node->GetString();
+
+}
+
+//==============================================================================
+std::string DataMapReaderSimple::String (
+    const DataPath & path,
+    const std::string & defaultValue
+) const {
+
+    const DataNode * node = IsValid() ? path.Resolve(m_reader.GetCurrentNode()) : nullptr;
+
+    if (node == nullptr || node->GetType() != DataNode::Type::String)
+        return defaultValue;
+
+    return node->GetString();
+
+}
+
 //==============================================================================
 bool DataMapReaderSimple::ToChild (const char * name) {
 
@@ -231,6 +447,27 @@ bool DataMapReaderSimple::ToChild (const char * name) {
 
 }
 
+//==============================================================================
+bool DataMapReaderSimple::ToChild (const DataKey & key) {
+
+    // If already invalid, just increase error depth so we can wait to come
+    // back out of an erroneous state.
+    if (!IsValid()) {
+        ++m_errorDepth;
+        return false;
+    }
+
+    m_reader.ToChild(key);
+    
+    if (!m_reader.IsValid()) {
+        ++m_errorDepth;
+        return false;
+    }
+    
+    return true;
+
+}
+
 //==============================================================================
 bool DataMapReaderSimple::ToFirstChild () {
 
@@ -0,0 +1,468 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <cassert>
+#include <cstring>
+
+#include "exported/DataMapBinary.hpp"
+#include "exported/DataMapSnapshotter.hpp"
+
+#define DATAMAPSNAPSHOTTER_BASIC_SAFETY_CHECKS 1
+
+namespace CSaruDataMap {
+
+//=========================================================================
+DataMapSnapshotter::DataMapSnapshotter (DataNode * root, DataMapMutatorListener * next)
+    : m_root(root)
+    , m_next(next)
+    , m_walking(false)
+    , m_progressFrame(0)
+    , m_mutatorLocked(false)
+    , m_inTransaction(false)
+    , m_finished(true)
+    , m_file(nullptr)
+    , m_ok(true)
+{
+    #if DATAMAPSNAPSHOTTER_BASIC_SAFETY_CHECKS
+        assert(root && "DataMapSnapshotter constructed with a null root.");
+    #endif
+}
+
+//=========================================================================
+DataMapSnapshotter::~DataMapSnapshotter () {
+    Wait();
+}
+
+//=========================================================================
+void DataMapSnapshotter::DetachChild (DataNode * parent, int index) {
+    // take the child whole (its handle included); the husk left behind is
+    //  what gets deleted.
+    m_detached.push_back(std::unique_ptr<DataNode>(new DataNode(std::move(parent->m_children[index]))));
+    m_detached.back()->m_parent        = nullptr;
+    m_detached.back()->m_indexInParent = -1;
+}
+
+//=========================================================================
+void DataMapSnapshotter::DetachChildren (DataNode * node) {
+    // NOTE: The children keep pointing at node as their parent.  Nothing
+    //  follows those links once they're detached.
+    m_detached.push_back(std::unique_ptr<DataNode>(new DataNode()));
+    m_detached.back()->m_children.swap(node->m_children);
+    node->BumpStructureVersion();
+}
+
+//=========================================================================
+DataMapSnapshotter::Saved * DataMapSnapshotter::FindSaved (const DataNode * node) {
+    if (node->m_handleSlot == 0)
+        return nullptr;
+
+    std::unordered_map<std::uint32_t, Saved>::iterator it = m_saved.find(node->m_handleSlot);
+    return it == m_saved.end() ? nullptr : &it->second;
+}
+
+//=========================================================================
+DataMapSnapshotter::Progress DataMapSnapshotter::GetProgress (const DataNode * node) {
+    m_chain.clear();
+    for (const DataNode * n = node;  n;  n = n->GetParent())
+        m_chain.push_back(n);
+    if (m_chain.back() != m_root)
+        return Progress::Written;
+
+    // m_chain runs up from node to the root, m_frames down from the root.
+    const int top   = int(m_chain.size()) - 1;
+    int       depth = 0;
+    while (
+        depth < top &&
+        depth + 1 < int(m_frames.size()) &&
+        m_frames[depth + 1].m_node.Resolve() == m_chain[top - depth - 1]
+    ) {
+        ++depth;
+    }
+
+    m_progressFrame = depth;
+    if (depth == top)
+        return Progress::Open;
+
+    // which side of the walk is the next node down?
+    const Frame &    frame  = m_frames[depth];
+    const DataNode * child  = m_chain[top - depth - 1];
+    const Saved *    saved  = FindSaved(m_chain[top - depth]);
+    int              index  = child->GetIndexInParent();
+    if (saved && saved->m_hasChildren) {
+        std::unordered_map<std::uint32_t, int>::const_iterator it = saved->m_indexOfSlot.find(child->m_handleSlot);
+        if (it == saved->m_indexOfSlot.end())
+            return Progress::Written;
+        index = it->second;
+    }
+
+    // anything past m_count was added since Start().
+    if (index < frame.m_next || index >= frame.m_count)
+        return Progress::Written;
+
+    // node is under a pending one, but may still have been added since.
+    for (int i = top - depth - 1;  i > 0;  --i) {
+        if (!WasChildAtStart(m_chain[i], m_chain[i - 1]))
+            return Progress::Written;
+    }
+    return Progress::Pending;
+}
+
+//=========================================================================
+int DataMapSnapshotter::GetStartChildCount (DataNode * node, Progress progress) {
+    if (progress == Progress::Open)
+        return m_frames[m_progressFrame].m_count;
+
+    const Saved * saved = FindSaved(node);
+    if (saved && saved->m_hasChildren)
+        return int(saved->m_children.size());
+    if (saved && saved->m_hasChildCount)
+        return saved->m_childCount;
+    return node->GetChildCount();
+}
+
+//=========================================================================
+bool DataMapSnapshotter::LockForChange (void) {
+    if (!m_mutatorLocked) {
+        if (!m_walking.load())
+            return false;
+        m_mutex.lock();
+        m_mutatorLocked = true;
+    }
+
+    // the walk may have finished while we waited.
+    return m_walking.load();
+}
+
+//=========================================================================
+void DataMapSnapshotter::SaveChildren (DataNode * node, Progress progress) {
+    const int childCount = GetStartChildCount(node, progress);
+
+    Saved & saved = m_saved[node->GetHandle().m_slot];
+    if (saved.m_hasChildren)
+        return;
+
+    // only appended to so far, so the first childCount are still the ones
+    //  from Start().
+    saved.m_hasChildren = true;
+    saved.m_children.reserve(childCount);
+    saved.m_indexOfSlot.reserve(childCount);
+    for (int i = 0;  i < childCount;  ++i) {
+        const DataNodeHandle handle = node->GetChildFast(i)->GetHandle();
+        saved.m_children.push_back(handle);
+        saved.m_indexOfSlot[handle.m_slot] = i;
+    }
+}
+
+//=========================================================================
+void DataMapSnapshotter::SaveChildCount (DataNode * node, int childCount) {
+    Saved & saved = m_saved[node->GetHandle().m_slot];
+    if (!saved.m_hasChildren && !saved.m_hasChildCount) {
+        saved.m_hasChildCount = true;
+        saved.m_childCount    = childCount;
+    }
+}
+
+//=========================================================================
+void DataMapSnapshotter::SaveHeader (DataNode * node) {
+    Saved & saved = m_saved[node->GetHandle().m_slot];
+    if (saved.m_hasHeader)
+        return;
+
+    saved.m_hasHeader = true;
+    std::memcpy(saved.m_header.m_name, node->m_name, sizeof(saved.m_header.m_name));
+    saved.m_header.m_nameHash = node->m_nameHash;
+    saved.m_header.m_type     = node->m_type;
+    std::memcpy(&saved.m_header.m_data, &node->m_data, sizeof(saved.m_header.m_data));
+}
+
+//=========================================================================
+bool DataMapSnapshotter::Start (const char * path) {
+    if (m_thread.joinable()) {
+        if (!m_finished.load())
+            return false;
+        m_thread.join();
+    }
+
+    m_file = DataMapBinary::OpenTempFile(path, &m_tempPath);
+    if (m_file == nullptr)
+        return false;
+
+    m_path = path;
+    m_ok   = true;
+    m_buffer.clear();
+    DataMapBinary::AppendUint32(DataMapBinary::s_snapshotMagic, &m_buffer);
+
+    // nothing else is walking the tree yet.
+    m_frames.clear();
+    WriteNodeHeader(m_root);
+
+    m_finished.store(false);
+    m_walking.store(!m_frames.empty());
+    m_thread = std::thread(&DataMapSnapshotter::ThreadMain, this);
+    return true;
+}
+
+//=========================================================================
+void DataMapSnapshotter::ThreadMain (void) {
+    std::vector<std::unique_ptr<DataNode>> detached;
+
+    for (bool more = true;  more;  ) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            more = WriteChunk();
+            if (!more) {
+                m_walking.store(false);
+                m_saved.clear();
+                detached.swap(m_detached);
+            }
+        }
+
+        if (m_buffer.size() >= std::size_t(s_bytesPerWrite) || !more) {
+            if (m_ok)
+                m_ok = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size();
+            m_buffer.clear();
+        }
+
+        // give waiting Mutators a turn.
+        std::this_thread::yield();
+    }
+
+    m_ok   = DataMapBinary::CommitTempFile(m_file, m_tempPath.c_str(), m_path.c_str(), m_ok);
+    m_file = nullptr;
+    m_finished.store(true);
+}
+
+//=========================================================================
+bool DataMapSnapshotter::Wait (void) {
+    if (m_thread.joinable())
+        m_thread.join();
+    return m_ok;
+}
+
+//=========================================================================
+bool DataMapSnapshotter::WriteChunk (void) {
+    for (int written = 0;  written < s_nodesPerChunk && !m_frames.empty();  ) {
+        Frame &    frame = m_frames.back();
+        DataNode * node  = frame.m_node.Resolve();
+
+        #if DATAMAPSNAPSHOTTER_BASIC_SAFETY_CHECKS
+            assert(node && "DataMapSnapshotter lost a node it still had to write.");
+        #endif
+
+        if (frame.m_next == frame.m_count) {
+            m_saved.erase(node->m_handleSlot);
+            m_frames.pop_back();
+            continue;
+        }
+
+        const Saved * saved = FindSaved(node);
+        DataNode *    child = saved && saved->m_hasChildren
+            ? saved->m_children[frame.m_next].Resolve()
+            : node->GetChildFast(frame.m_next);
+        ++frame.m_next;
+
+        #if DATAMAPSNAPSHOTTER_BASIC_SAFETY_CHECKS
+            assert(child && "DataMapSnapshotter lost a node it still had to write.");
+        #endif
+
+        WriteNodeHeader(child);
+        ++written;
+    }
+
+    return !m_frames.empty();
+}
+
+//=========================================================================
+bool DataMapSnapshotter::WasChildAtStart (const DataNode * parent, const DataNode * child) {
+    const Saved * saved = FindSaved(parent);
+    if (saved == nullptr)
+        return true;
+    if (saved->m_hasHeader && !saved->m_header.IsContainerType())
+        return false;
+    if (saved->m_hasChildren)
+        return saved->m_indexOfSlot.find(child->m_handleSlot) != saved->m_indexOfSlot.end();
+    if (saved->m_hasChildCount)
+        return child->GetIndexInParent() < saved->m_childCount;
+    return true;
+}
+
+//=========================================================================
+void DataMapSnapshotter::WriteNodeHeader (DataNode * node) {
+    const Saved *    saved  = FindSaved(node);
+    const DataNode & header = saved && saved->m_hasHeader ? saved->m_header : *node;
+
+    int childCount = 0;
+    if (header.IsContainerType()) {
+        if (saved && saved->m_hasChildren)
+            childCount = int(saved->m_children.size());
+        else if (saved && saved->m_hasChildCount)
+            childCount = saved->m_childCount;
+        else
+            childCount = node->GetChildCount();
+    }
+
+    DataMapBinary::AppendNodeHeader(header, childCount, &m_buffer);
+
+    if (childCount > 0) {
+        Frame frame;
+        frame.m_node  = node->GetHandle();
+        frame.m_next  = 0;
+        frame.m_count = childCount;
+        m_frames.push_back(frame);
+    }
+    else if (saved) {
+        m_saved.erase(node->m_handleSlot);
+    }
+}
+
+//=========================================================================
+void DataMapSnapshotter::AfterChange (void) {
+    if (m_next)
+        m_next->AfterChange();
+
+    if (m_mutatorLocked) {
+        m_mutatorLocked = false;
+        m_mutex.unlock();
+    }
+}
+
+//=========================================================================
+void DataMapSnapshotter::BeforeDelete (DataNode * parent, int index) {
+    if (m_next)
+        m_next->BeforeDelete(parent, index);
+    if (!LockForChange())
+        return;
+
+    const Progress progress = GetProgress(parent);
+    if (progress == Progress::Written)
+        return;
+
+    // a transaction keeps the child itself.
+    SaveChildren(parent, progress);
+    if (!m_inTransaction && GetProgress(parent->GetChildFast(index)) != Progress::Written)
+        DetachChild(parent, index);
+}
+
+//=========================================================================
+void DataMapSnapshotter::BeforeInsert (DataNode * parent, int index) {
+    if (m_next)
+        m_next->BeforeInsert(parent, index);
+    if (!LockForChange())
+        return;
+
+    const Progress progress = GetProgress(parent);
+    if (progress == Progress::Written)
+        return;
+
+    // adding a child to a value turns it into an Object.
+    if (!parent->IsContainerType()) {
+        if (progress == Progress::Pending)
+            SaveHeader(parent);
+        return;
+    }
+
+    // appending moves no one.  An open node's frame already knows how many
+    //  children to write; a pending one needs telling.
+    if (index == parent->GetChildCount()) {
+        if (progress == Progress::Pending)
+            SaveChildCount(parent, index);
+        return;
+    }
+
+    SaveChildren(parent, progress);
+}
+
+//=========================================================================
+void DataMapSnapshotter::BeforeMove (DataNode * parent, int fromIndex, int toIndex) {
+    if (m_next)
+        m_next->BeforeMove(parent, fromIndex, toIndex);
+    if (!LockForChange())
+        return;
+
+    const Progress progress = GetProgress(parent);
+    if (progress != Progress::Written)
+        SaveChildren(parent, progress);
+}
+
+//=========================================================================
+void DataMapSnapshotter::BeforeNodeChange (DataNode * node, bool keepChildren) {
+    if (m_next)
+        m_next->BeforeNodeChange(node, keepChildren);
+    if (!LockForChange())
+        return;
+
+    const Progress progress = GetProgress(node);
+    if (progress == Progress::Written)
+        return;
+
+    if (progress == Progress::Pending)
+        SaveHeader(node);
+    if (keepChildren)
+        return;
+
+    if (node->HasChildren()) {
+        SaveChildren(node, progress);
+        if (!m_inTransaction)
+            DetachChildren(node);
+    }
+    else if (progress == Progress::Pending) {
+        // whatever children it gets instead are new.
+        SaveChildCount(node, 0);
+    }
+}
+
+//=========================================================================
+void DataMapSnapshotter::BeforeTransactionCommit (std::vector<DataNode> * logged) {
+    if (m_next)
+        m_next->BeforeTransactionCommit(logged);
+
+    // the walk may still need what the transaction kept.  Moving the nodes
+    //  keeps their handles (and their children) where the walk finds them.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_walking.load())
+        return;
+    m_detached.reserve(m_detached.size() + logged->size());
+    for (DataNode & node : *logged)
+        m_detached.push_back(std::unique_ptr<DataNode>(new DataNode(std::move(node))));
+}
+
+//=========================================================================
+void DataMapSnapshotter::OnTransactionBegin (void) {
+    if (m_next)
+        m_next->OnTransactionBegin();
+    m_inTransaction = true;
+}
+
+//=========================================================================
+void DataMapSnapshotter::OnTransactionCommit (void) {
+    if (m_next)
+        m_next->OnTransactionCommit();
+    m_inTransaction = false;
+}
+
+//=========================================================================
+void DataMapSnapshotter::OnTransactionRollback (void) {
+    if (m_next)
+        m_next->OnTransactionRollback();
+    m_inTransaction = false;
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,246 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "exported/DataMapMutator.hpp"
+#include "exported/DataMapTransaction.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+DataMapTransaction::DataMapTransaction (DataNode * root, DataMapMutatorListener * next)
+    : m_root(root)
+    , m_next(next)
+    , m_active(false)
+{
+    #ifdef _DEBUG
+        assert(root && "DataMapTransaction constructed with root == nullptr.");
+    #endif
+}
+
+//=========================================================================
+DataMapTransaction::~DataMapTransaction () {
+    if (m_active)
+        Rollback();
+}
+
+//=========================================================================
+DataMapTransaction::Entry & DataMapTransaction::AddEntry (Entry::Kind kind, const DataNode * node) {
+    Entry entry;
+    entry.m_kind         = kind;
+    entry.m_pathBegin    = int(m_pathIndices.size());
+    entry.m_index        = -1;
+    entry.m_toIndex      = -1;
+    entry.m_saved        = -1;
+    entry.m_keptChildren = true;
+
+    // the node's path from the root, pushed backward then flipped.
+    for (;  node != m_root;  node = node->GetParent()) {
+        #ifdef _DEBUG
+            assert(node && "DataMapTransaction asked to log a change outside of its root.");
+        #endif
+        m_pathIndices.push_back(node->GetIndexInParent());
+    }
+    std::reverse(m_pathIndices.begin() + entry.m_pathBegin, m_pathIndices.end());
+    entry.m_pathLength = int(m_pathIndices.size()) - entry.m_pathBegin;
+
+    m_entries.push_back(entry);
+    return m_entries.back();
+}
+
+//=========================================================================
+void DataMapTransaction::Begin (void) {
+    #ifdef _DEBUG
+        assert(!m_active && "DataMapTransaction::Begin() called, but a transaction is already active.");
+    #endif
+
+    m_active = true;
+    if (m_next)
+        m_next->OnTransactionBegin();
+}
+
+//=========================================================================
+void DataMapTransaction::Commit (void) {
+    #ifdef _DEBUG
+        assert(m_active && "DataMapTransaction::Commit() called, but no transaction is active.");
+    #endif
+
+    if (m_next)
+        m_next->BeforeTransactionCommit(&m_savedNodes);
+    Forget();
+    if (m_next)
+        m_next->OnTransactionCommit();
+}
+
+//=========================================================================
+DataNode * DataMapTransaction::FindNode (const Entry & entry) const {
+    DataNode * node = m_root;
+    const int * path = m_pathIndices.data() + entry.m_pathBegin;
+    for (int i = 0;  i < entry.m_pathLength;  ++i)
+        node = node->GetChildFast(path[i]);
+    return node;
+}
+
+//=========================================================================
+void DataMapTransaction::Forget (void) {
+    m_entries.clear();
+    m_pathIndices.clear();
+    m_savedNodes.clear();
+    m_active = false;
+}
+
+//=========================================================================
+DataMapMutator DataMapTransaction::GetMutator (void) {
+    DataMapMutator mutator(m_root);
+    mutator.SetListener(this);
+    return mutator;
+}
+
+//=========================================================================
+void DataMapTransaction::AfterChange (void) {
+    if (m_next)
+        m_next->AfterChange();
+}
+
+//=========================================================================
+void DataMapTransaction::BeforeDelete (DataNode * parent, int index) {
+    if (m_next)
+        m_next->BeforeDelete(parent, index);
+    if (!m_active)
+        return;
+
+    Entry & entry = AddEntry(Entry::Kind::Delete, parent);
+    entry.m_index = index;
+    entry.m_saved = int(m_savedNodes.size());
+
+    // take the child whole (its handle included); the husk left behind is
+    //  what gets deleted.
+    m_savedNodes.push_back(std::move(parent->m_children[index]));
+    m_savedNodes.back().m_parent        = nullptr;
+    m_savedNodes.back().m_indexInParent = -1;
+}
+
+//=========================================================================
+void DataMapTransaction::BeforeInsert (DataNode * parent, int index) {
+    if (m_next)
+        m_next->BeforeInsert(parent, index);
+    if (!m_active)
+        return;
+
+    // adding a child to a value turns it into an Object.
+    if (!parent->IsContainerType())
+        LogNodeChange(parent, true);
+
+    Entry & entry = AddEntry(Entry::Kind::Insert, parent);
+    entry.m_index = index;
+}
+
+//=========================================================================
+void DataMapTransaction::BeforeMove (DataNode * parent, int fromIndex, int toIndex) {
+    if (m_next)
+        m_next->BeforeMove(parent, fromIndex, toIndex);
+    if (!m_active)
+        return;
+
+    Entry & entry = AddEntry(Entry::Kind::Move, parent);
+    entry.m_index   = fromIndex;
+    entry.m_toIndex = toIndex;
+}
+
+//=========================================================================
+void DataMapTransaction::BeforeNodeChange (DataNode * node, bool keepChildren) {
+    if (m_next)
+        m_next->BeforeNodeChange(node, keepChildren);
+    if (m_active)
+        LogNodeChange(node, keepChildren);
+}
+
+//=========================================================================
+void DataMapTransaction::LogNodeChange (DataNode * node, bool keepChildren) {
+    Entry & entry = AddEntry(Entry::Kind::Node, node);
+    entry.m_saved        = int(m_savedNodes.size());
+    entry.m_keptChildren = keepChildren;
+
+    m_savedNodes.push_back(DataNode());
+    DataNode & saved = m_savedNodes.back();
+    std::memcpy(saved.m_name, node->m_name, sizeof(saved.m_name));
+    saved.m_nameHash = node->m_nameHash;
+    saved.m_type     = node->m_type;
+    std::memcpy(&saved.m_data, &node->m_data, sizeof(saved.m_data));
+
+    if (!keepChildren && !node->m_children.empty()) {
+        saved.m_children.swap(node->m_children);
+        node->BumpStructureVersion();
+    }
+}
+
+//=========================================================================
+void DataMapTransaction::Rollback (void) {
+    #ifdef _DEBUG
+        assert(m_active && "DataMapTransaction::Rollback() called, but no transaction is active.");
+    #endif
+
+    for (int e = int(m_entries.size()) - 1;  e >= 0;  --e) {
+        const Entry & entry = m_entries[e];
+        DataNode *    node  = FindNode(entry);
+
+        switch (entry.m_kind) {
+            case Entry::Kind::Node: {
+                DataNode & saved = m_savedNodes[entry.m_saved];
+                std::memcpy(node->m_name, saved.m_name, sizeof(node->m_name));
+                node->m_nameHash = saved.m_nameHash;
+                node->m_type     = saved.m_type;
+                std::memcpy(&node->m_data, &saved.m_data, sizeof(node->m_data));
+
+                if (entry.m_keptChildren) {
+                    node->InvalidateSubtreeHash();
+                } else {
+                    node->m_children.swap(saved.m_children);
+                    node->RelinkChildren(0);
+                    node->BumpStructureVersion();
+                }
+            } break;
+
+            case Entry::Kind::Insert: {
+                node->DeleteChild(entry.m_index);
+            } break;
+
+            case Entry::Kind::Delete: {
+                DataNode * child = node->InsertNewChild(entry.m_index);
+                *child = std::move(m_savedNodes[entry.m_saved]);
+            } break;
+
+            case Entry::Kind::Move: {
+                node->MoveChild(entry.m_toIndex, entry.m_index);
+            } break;
+        }
+    }
+
+    Forget();
+    if (m_next)
+        m_next->OnTransactionRollback();
+}
+
+} // namespace CSaruDataMap
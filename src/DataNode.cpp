@@ -18,8 +18,10 @@ freely, subject to the following restrictions:
 3. This notice may not be removed or altered from any source distribution.
 */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 #include "exported/DataNode.hpp"
 
@@ -35,7 +37,63 @@ freely, subject to the following restrictions:
 namespace CSaruDataMap {
 
 //=========================================================================
-DataNode::DataNode (const DataNode & other) {
+static inline std::uint64_t MixHash (std::uint64_t hash, std::uint64_t word) {
+    std::uint64_t h = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+//=========================================================================
+// Word at a time, with four independent lanes over each 32-byte block so the
+//  multiplies can overlap (or be vectorized).
+static std::uint64_t HashBytes (const void * data, std::size_t length, std::uint64_t seed) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    std::uint64_t         hash  = seed;
+
+    if (length >= 32) {
+        std::uint64_t lanes[4] = {
+            seed,
+            seed ^ 0x243F6A8885A308D3ull,
+            seed ^ 0x13198A2E03707344ull,
+            seed ^ 0xA4093822299F31D0ull
+        };
+        for (;  length >= 32;  bytes += 32, length -= 32) {
+            for (int lane = 0;  lane < 4;  ++lane) {
+                std::uint64_t word;
+                memcpy(&word, bytes + lane * 8, 8);
+                lanes[lane] = MixHash(lanes[lane], word);
+            }
+        }
+        hash = MixHash(MixHash(lanes[0], lanes[1]), MixHash(lanes[2], lanes[3]));
+    }
+
+    for (;  length >= 8;  bytes += 8, length -= 8) {
+        std::uint64_t word;
+        memcpy(&word, bytes, 8);
+        hash = MixHash(hash, word);
+    }
+
+    std::uint64_t tail = 0;
+    memcpy(&tail, bytes, length);
+    return MixHash(hash, tail ^ (std::uint64_t(length) << 56));
+}
+
+//=========================================================================
+DataNode::~DataNode () {
+    if (m_handleSlot)
+        DataNodeHandleTable::Release(m_handleSlot);
+}
+
+//=========================================================================
+DataNode::DataNode (const DataNode & other)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     /*
     memcpy(m_name, other.m_name, s_nameSize);
     // NOTE: This assumes that the m_stringm_data is of 1-byte chars, and is the
@@ -50,6 +108,8 @@ DataNode::DataNode (const DataNode & other) {
     // NOTE: This assumes that the m_stringm_data is the largest data member
 	memcpy(m_data.m_string, other.m_data.m_string, sizeof(m_data.m_string));
     m_children = other.m_children;
+    RelinkChildren(0);
+    m_subtreeHash.store(other.m_subtreeHash.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 //=========================================================================
@@ -63,57 +123,174 @@ DataNode & DataNode::operator= (const DataNode & rhs) {
 
     //memcpy(this, &rhs, sizeof(DataNode));
 
-    SetName(rhs.m_name);
-    SetType(rhs.m_type);
+    if (this == &rhs)
+        return *this;
+
+    // a handle to this node must not find the new contents.
+    if (m_handleSlot) {
+        DataNodeHandleTable::Release(m_handleSlot);
+        m_handleSlot = 0;
+    }
+
+    char name[s_nameSize];
+    memcpy(name, rhs.m_name, sizeof(name));
+    SetContents(rhs);
+    SetName(name);
+
+    return *this;
+}
+
+//=========================================================================
+DataNode::DataNode (DataNode && other) noexcept
+    : m_type(other.m_type)
+    , m_children(std::move(other.m_children))
+    , m_parent(other.m_parent)
+    , m_indexInParent(other.m_indexInParent)
+    , m_handleSlot(other.m_handleSlot.load(std::memory_order_relaxed))
+    , m_structureVersion(other.m_structureVersion)
+    , m_subtreeHash(other.m_subtreeHash.load(std::memory_order_relaxed))
+{
+    memcpy(m_name, other.m_name, sizeof(m_name));
+    m_nameHash = other.m_nameHash;
+    // NOTE: This assumes that the m_stringm_data is the largest data member
+    memcpy(m_data.m_string, other.m_data.m_string, sizeof(m_data.m_string));
+    // the children themselves didn't move, but their parent did
+    for (DataNode & child : m_children)
+        child.m_parent = this;
+
+    other.m_handleSlot = 0;
+    if (m_handleSlot)
+        DataNodeHandleTable::Relocate(m_handleSlot, this);
+}
+
+//=========================================================================
+DataNode & DataNode::operator= (DataNode && rhs) noexcept {
+    if (this == &rhs)
+        return *this;
+
+    if (m_handleSlot)
+        DataNodeHandleTable::Release(m_handleSlot);
+
+    memcpy(m_name, rhs.m_name, sizeof(m_name));
+    m_nameHash = rhs.m_nameHash;
+    m_type = rhs.m_type;
     // NOTE: This assumes that the m_stringm_data is the largest data member
     memcpy(m_data.m_string, rhs.m_data.m_string, sizeof(m_data.m_string));
-    m_children = rhs.m_children;
+    m_children = std::move(rhs.m_children);
+    for (DataNode & child : m_children)
+        child.m_parent = this;
+    // whoever is shifting nodes around takes care of bumping the ancestors.
+    ++m_structureVersion;
+    InvalidateSubtreeHash();
+    m_subtreeHash.store(rhs.m_subtreeHash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    m_handleSlot.store(rhs.m_handleSlot.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    if (m_handleSlot)
+        DataNodeHandleTable::Relocate(m_handleSlot, this);
 
     return *this;
 }
 
 //=========================================================================
-DataNode::DataNode (const char * name, Type type) {
+DataNode::DataNode (const char * name, Type type)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     SetName(name);
     SetType(type);
 }
 
 //=========================================================================
-DataNode::DataNode (const char * name, int m_intdata) {
+DataNode::DataNode (const char * name, int m_intdata)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     SetName(name);
     SetInt(m_intdata);
 }
 
 //=========================================================================
-DataNode::DataNode (const char * name, float m_floatdata) {
+DataNode::DataNode (const char * name, float m_floatdata)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     SetName(name);
     SetFloat(m_floatdata);
 }
 
 //=========================================================================
-DataNode::DataNode (const char * name, const char * m_stringdata) {
+DataNode::DataNode (const char * name, const char * m_stringdata)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     SetName(name);
     SetString(m_stringdata);
 }
 
 //=========================================================================
-DataNode::DataNode (const char * name, bool m_booldata) {
+DataNode::DataNode (const char * name, bool m_booldata)
+    : m_parent(nullptr)
+    , m_indexInParent(-1)
+    , m_handleSlot(0)
+    , m_structureVersion(0)
+    , m_subtreeHash(0)
+{
     SetName(name);
     SetBool(m_booldata);
 }
 
+//=========================================================================
+void DataNode::RelinkChildren (int firstIndex) {
+    const int childCount = int(m_children.size());
+    for (int i = firstIndex;  i < childCount;  ++i) {
+        m_children[i].m_parent        = this;
+        m_children[i].m_indexInParent = i;
+    }
+}
+
+//=========================================================================
+void DataNode::BumpStructureVersion (void) {
+    for (DataNode * node = this;  node;  node = node->m_parent) {
+        ++node->m_structureVersion;
+        node->m_subtreeHash.store(0, std::memory_order_relaxed);
+    }
+}
+
+//=========================================================================
+void DataNode::InvalidateSubtreeHash (void) {
+    m_subtreeHash.store(0, std::memory_order_relaxed);
+    for (DataNode * node = m_parent;  node && node->m_subtreeHash.load(std::memory_order_relaxed);  node = node->m_parent)
+        node->m_subtreeHash.store(0, std::memory_order_relaxed);
+}
+
 //=========================================================================
 void DataNode::Initialize (void) {
     strcpy(m_name, "_INIT_m_name");
+    m_nameHash = DataKey::HashString(m_name);
     m_type = Type::String;
     strcpy(m_data.m_string, "_INIT_m_data");
+    InvalidateSubtreeHash();
 }
 
 //=========================================================================
 void DataNode::Sanitize (void) {
     m_name[s_nameSize-1] = '\0';
+    m_nameHash = DataKey::HashString(m_name);
     //if (m_type == Type::String)
     m_data.m_string[s_stringDataSize-1] = '\0';
+    InvalidateSubtreeHash();
 }
 
 //=========================================================================
@@ -158,9 +335,74 @@ bool DataNode::QueryBool (bool * outBool) const {
         return true;
 }
 
+//=========================================================================
+DataNodeHandle DataNode::GetHandle (void) {
+    std::uint32_t slot = m_handleSlot.load(std::memory_order_acquire);
+    if (slot == 0) {
+        // readers sharing a const tree may race to give it its handle (see
+        //  DataPath::Resolve()); the loser gives its slot back.
+        const std::uint32_t acquired = DataNodeHandleTable::Acquire(this);
+        if (m_handleSlot.compare_exchange_strong(slot, acquired, std::memory_order_acq_rel, std::memory_order_acquire))
+            slot = acquired;
+        else
+            DataNodeHandleTable::Release(acquired);
+    }
+    return DataNodeHandle(slot, DataNodeHandleTable::GetEntry(slot).m_generation.load(std::memory_order_relaxed));
+}
+
+//=========================================================================
+DataNode * DataNode::SetContents (const DataNode & value) {
+    // copy everything first, in case value is about to be let go below.
+    std::vector<DataNode> children(value.m_children);
+    const Type            type = value.m_type;
+    const std::uint64_t   hash = value.m_subtreeHash.load(std::memory_order_relaxed);
+    char                  data[sizeof(m_data)];
+    memcpy(data, &value.m_data, sizeof(data));
+
+    // the old children are freed (and their handles released) with children.
+    m_type = type;
+    memcpy(&m_data, data, sizeof(m_data));
+    m_children.swap(children);
+    RelinkChildren(0);
+    BumpStructureVersion();
+    m_subtreeHash.store(hash, std::memory_order_relaxed);
+    return this;
+}
+
+//=========================================================================
+std::uint64_t DataNode::GetSubtreeHash (void) const {
+    const std::uint64_t typeSeed = MixHash(0xCBF29CE484222325ull, std::uint64_t(m_type));
+
+    switch (m_type) {
+        case Type::Bool:    return HashBytes(&m_data.m_bool, sizeof(m_data.m_bool), typeSeed);
+        case Type::Int:     return HashBytes(&m_data.m_int, sizeof(m_data.m_int), typeSeed);
+        case Type::Float:   return HashBytes(&m_data.m_float, sizeof(m_data.m_float), typeSeed);
+        case Type::String:  return HashBytes(m_data.m_string, strlen(m_data.m_string), typeSeed);
+        case Type::Object:
+        case Type::Array:   break;
+        default:            return typeSeed;
+    }
+
+    std::uint64_t hash = m_subtreeHash.load(std::memory_order_relaxed);
+    if (hash)
+        return hash;
+
+    hash = typeSeed;
+    for (const DataNode & child : m_children)
+        hash = MixHash(hash, HashBytes(child.m_name, strlen(child.m_name), child.GetSubtreeHash()));
+
+    // 0 means "not cached"
+    if (hash == 0)
+        hash = 1;
+    m_subtreeHash.store(hash, std::memory_order_relaxed);
+    return hash;
+}
+
 //=========================================================================
 DataNode * DataNode::SetName (const char * new_name) {
     strcpy(m_name, new_name);
+    m_nameHash = DataKey::HashString(m_name);
+    InvalidateSubtreeHash();
     return this;
 }
 
@@ -171,7 +413,8 @@ DataNode * DataNode::SetNameSecure (const char * new_name, int size_in_elements)
     m_name[0] = '\0';
 
     if (new_name != nullptr) {
-        while (i < size_in_elements  &&  i < static_cast<int>(s_nameSize)) {
+        // leave room for the null-terminating character
+        while (i < size_in_elements  &&  i < static_cast<int>(s_nameSize) - 1) {
             m_name[i] = new_name[i];
             ++i;
         }
@@ -183,6 +426,8 @@ DataNode * DataNode::SetNameSecure (const char * new_name, int size_in_elements)
     // write null at last possible char, to protect against read-until-null-char
     //   reading outside our buffer.
     //m_name[s_nameSize - 1] = '\0';
+    m_nameHash = DataKey::HashString(m_name);
+    InvalidateSubtreeHash();
     return this;
 }
 
@@ -191,8 +436,11 @@ DataNode * DataNode::SetType (Type type) {
     m_type = type;
     if (m_type != Type::Object && m_type != Type::Array)
         DeleteAllChildren();
-    else
+    else if (m_children.empty())
         m_children.reserve(4);
+    else
+        ReserveChildren(4);     // may move the children; cursors must hear of it
+    InvalidateSubtreeHash();
     return this;
 }
 
@@ -248,33 +496,57 @@ DataNode * DataNode::SetBool (bool new_bool) {
 
 //=========================================================================
 const DataNode * DataNode::GetChildByName (const char * name) const {
-    int childCount = int(m_children.size());
-    for (int i = 0;  i < childCount;  ++i) {
-        // if we find a match, return it
-        if (!strcmp(m_children[i].GetName(), name))
-            return &m_children[i];
-    }
-    return nullptr;
+    // hash once, then compare hashes instead of strings
+    return GetChildByName(DataKey::FromString(name));
 }
 
 //=========================================================================
 DataNode * DataNode::GetChildByName (const char * name) {
+    return GetChildByName(DataKey::FromString(name));
+}
+
+//=========================================================================
+const DataNode * DataNode::GetChildByName (const DataKey & key) const {
+    // no stored name can be this long
+    if (key.m_length >= s_nameSize)
+        return nullptr;
+
     int childCount = int(m_children.size());
     for (int i = 0;  i < childCount;  ++i) {
         // if we find a match, return it
-        if (!strcmp(m_children[i].GetName(), name))
-            return &m_children[i];
+        const DataNode & child = m_children[i];
+        if (child.m_nameHash == key.m_hash && key.MatchesName(child.m_name))
+            return &child;
     }
     return nullptr;
 }
 
+//=========================================================================
+DataNode * DataNode::GetChildByName (const DataKey & key) {
+    return const_cast<DataNode *>(static_cast<const DataNode *>(this)->GetChildByName(key));
+}
+
 //=========================================================================
 DataNode * DataNode::AppendNewChild (void) {
     //m_children.resize(m_children.size() + 1);
     m_children.push_back(CSaruDataMap::DataNode());
     if (m_type != Type::Object && m_type != Type::Array)
         SetType(Type::Object);
-    return &m_children.back();
+
+    DataNode * child = &m_children.back();
+    child->m_parent        = this;
+    child->m_indexInParent = int(m_children.size()) - 1;
+    BumpStructureVersion();
+    return child;
+}
+
+//=========================================================================
+void DataNode::ReserveChildren (int count) {
+    if (count <= int(m_children.capacity()))
+        return;
+
+    m_children.reserve(count);
+    BumpStructureVersion();
 }
 
 //=========================================================================
@@ -287,8 +559,13 @@ DataNode * DataNode::InsertNewChild (int index) {
          "DataNode.");
     #endif
 
-    // copy all children from [index, last_child] in reverse order
-    return &*m_children.insert(m_children.begin() + index, DataNode());
+    // move all children from [index, last_child] in reverse order
+    m_children.insert(m_children.begin() + index, DataNode());
+    // everything from index on has a new index, and may have a new parent
+    //  pointer if m_children had to grow.
+    RelinkChildren(index);
+    BumpStructureVersion();
+    return &m_children[index];
     // reset the child at [index]
     //  (currently unnecessary.  std::vector::insert() takes a copy of a
     //  default-constructed DataNode above)
@@ -302,13 +579,48 @@ DataNode * DataNode::InsertNewChild (int index) {
 
 //=========================================================================
 void DataNode::DeleteLastChild (void) {
-    if (!m_children.empty())
+    if (!m_children.empty()) {
         m_children.pop_back();
+        BumpStructureVersion();
+    }
 }
 
 //=========================================================================
+void DataNode::DeleteChild (int index) {
+    #ifdef _DEBUG
+        assert(index >= 0 && index < GetChildCount() && "DataNode::DeleteChild() called with an invalid index.");
+    #endif
+
+    m_children.erase(m_children.begin() + index);
+    RelinkChildren(index);
+    BumpStructureVersion();
+}
+
+//=========================================================================
+void DataNode::MoveChild (int fromIndex, int toIndex) {
+    #ifdef _DEBUG
+        assert(fromIndex >= 0 && fromIndex < GetChildCount() && "DataNode::MoveChild() called with an invalid fromIndex.");
+        assert(toIndex >= 0 && toIndex < GetChildCount() && "DataNode::MoveChild() called with an invalid toIndex.");
+    #endif
+
+    if (fromIndex == toIndex)
+        return;
+
+    const std::vector<DataNode>::iterator begin = m_children.begin();
+    if (fromIndex < toIndex)
+        std::rotate(begin + fromIndex, begin + fromIndex + 1, begin + toIndex + 1);
+    else
+        std::rotate(begin + toIndex, begin + fromIndex, begin + fromIndex + 1);
+
+    RelinkChildren(fromIndex < toIndex ? fromIndex : toIndex);
+    BumpStructureVersion();
+}
+
 DataNode * DataNode::DeleteAllChildren (void) {
-    m_children.clear();
+    if (!m_children.empty()) {
+        m_children.clear();
+        BumpStructureVersion();
+    }
     return this;
 }
 
@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include "exported/DataNodeHandle.hpp"
+
+namespace CSaruDataMap {
+
+std::atomic<DataNodeHandleTable::Entry *> DataNodeHandleTable::s_blocks[DataNodeHandleTable::s_maxBlocks];
+
+// guards the free list and block allocation.  Resolving and relocating don't
+//  need it; they only touch entries which are already handed out.
+static std::mutex    s_tableMutex;
+static std::uint32_t s_firstFree = 0;   // 0 when the free list is empty
+static std::uint32_t s_nextUnused = 1;  // slot 0 is reserved for the null handle
+
+//=========================================================================
+std::uint32_t DataNodeHandleTable::Acquire (DataNode * node) {
+    std::lock_guard<std::mutex> lock(s_tableMutex);
+
+    std::uint32_t slot = s_firstFree;
+    if (slot != 0) {
+        s_firstFree = GetEntry(slot).m_nextFree;
+    }
+    else {
+        slot = s_nextUnused++;
+        const std::uint32_t block = slot >> s_blockBits;
+        if (block >= s_maxBlocks) {
+            // handing out a slot that isn't there would corrupt memory.
+            fprintf(stderr, "DataNodeHandleTable::Acquire() ran out of slots (%u in use).\n", s_maxBlocks * s_blockSize - 1);
+            std::abort();
+        }
+        if (s_blocks[block].load(std::memory_order_relaxed) == nullptr) {
+            Entry * entries = new Entry[s_blockSize];
+            for (unsigned i = 0;  i < s_blockSize;  ++i) {
+                entries[i].m_node.store(nullptr, std::memory_order_relaxed);
+                entries[i].m_generation.store(1, std::memory_order_relaxed);
+                entries[i].m_nextFree = 0;
+            }
+            s_blocks[block].store(entries, std::memory_order_release);
+        }
+    }
+
+    Entry & entry = GetEntry(slot);
+    entry.m_node.store(node, std::memory_order_relaxed);
+    entry.m_nextFree = 0;
+    return slot;
+}
+
+//=========================================================================
+void DataNodeHandleTable::Release (std::uint32_t slot) {
+    std::lock_guard<std::mutex> lock(s_tableMutex);
+
+    Entry & entry = GetEntry(slot);
+    entry.m_node.store(nullptr, std::memory_order_relaxed);
+    entry.m_generation.fetch_add(1, std::memory_order_release);
+    entry.m_nextFree = s_firstFree;
+    s_firstFree = slot;
+}
+
+} // namespace CSaruDataMap
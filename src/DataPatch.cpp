@@ -0,0 +1,324 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "exported/DataMapMutator.hpp"
+#include "exported/DataPatch.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// what Array children are matched up on: their name and their contents.
+static std::uint64_t GetMatchKey (const DataNode & node, bool byContent) {
+    const std::uint64_t nameKey = std::uint64_t(node.GetNameHash()) * 0x9E3779B97F4A7C15ull;
+    return byContent ? nameKey ^ node.GetSubtreeHash() : nameKey;
+}
+
+//=========================================================================
+// marks the values making up a longest increasing subsequence of values.
+// RETURNS: its length.
+static int MarkLongestIncreasing (const std::vector<int> & values, std::vector<char> * outKeep) {
+    const int count = int(values.size());
+    std::vector<int> tails;             // tails[k]: index of the smallest end of a run of length k + 1
+    std::vector<int> previous(count);   // previous[i]: index before i in its run
+    tails.reserve(count);
+
+    for (int i = 0;  i < count;  ++i) {
+        int low  = 0;
+        int high = int(tails.size());
+        while (low < high) {
+            const int mid = (low + high) / 2;
+            if (values[tails[mid]] < values[i])
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        previous[i] = low > 0 ? tails[low - 1] : -1;
+        if (low == int(tails.size()))
+            tails.push_back(i);
+        else
+            tails[low] = i;
+    }
+
+    for (int i = tails.empty() ? -1 : tails.back();  i >= 0;  i = previous[i])
+        (*outKeep)[values[i]] = 1;
+    return int(tails.size());
+}
+
+//=========================================================================
+const char * DataPatch::GetKindName (Op::Kind kind) {
+    switch (kind) {
+        case Op::Kind::Add:     return "add";
+        case Op::Kind::Remove:  return "remove";
+        case Op::Kind::Replace: return "replace";
+        case Op::Kind::Move:    return "move";
+    }
+    return "unknown";
+}
+
+//=========================================================================
+void DataPatch::AddOp (Op::Kind kind, int lastIndex, int toIndex, const DataNode * value) {
+    Op op;
+    op.m_kind       = kind;
+    op.m_pathBegin  = int(m_pathIndices.size());
+    op.m_pathLength = int(m_path.size()) + (lastIndex >= 0 ? 1 : 0);
+    op.m_toIndex    = toIndex;
+    op.m_value      = value ? int(m_values.size()) : -1;
+
+    m_pathIndices.insert(m_pathIndices.end(), m_path.begin(), m_path.end());
+    if (lastIndex >= 0)
+        m_pathIndices.push_back(lastIndex);
+    if (value)
+        m_values.push_back(*value);
+    m_ops.push_back(op);
+}
+
+//=========================================================================
+bool DataPatch::Apply (DataNode * root) const {
+    DataMapMutator   mutator(root);
+    std::vector<int> at;            // child indices taken to get mutator where it is
+    int              reservedUntil = -1;
+
+    const int opCount = int(m_ops.size());
+    for (int o = 0;  o < opCount;  ++o) {
+        const Op &  op   = m_ops[o];
+        const int * path = GetPath(op);
+
+        // go to the node being replaced, or to the parent of the one being
+        //  added/removed/moved, sharing as much of the way as possible with
+        //  the last op's.
+        const int depth  = op.m_kind == Op::Kind::Replace ? op.m_pathLength : op.m_pathLength - 1;
+        int       common = 0;
+        while (common < int(at.size()) && common < depth && at[common] == path[common])
+            ++common;
+        while (int(at.size()) > common) {
+            mutator.PopNode();
+            at.pop_back();
+        }
+        while (int(at.size()) < depth) {
+            const int index = path[at.size()];
+            if (index >= mutator.GetCurrentNode()->GetChildCount())
+                return false;
+            mutator.ToChild(index);
+            at.push_back(index);
+        }
+
+        DataNode * node       = mutator.GetCurrentNode();
+        const int  childCount = node->GetChildCount();
+        const int  last       = depth < op.m_pathLength ? path[depth] : -1;
+
+        switch (op.m_kind) {
+            case Op::Kind::Add: {
+                if (last > childCount)
+                    return false;
+
+                // a container's Adds are all together; make room for all of
+                //  them at once.
+                if (o > reservedUntil) {
+                    reservedUntil = o;
+                    while (
+                        reservedUntil + 1 < opCount &&
+                        m_ops[reservedUntil + 1].m_kind == Op::Kind::Add &&
+                        m_ops[reservedUntil + 1].m_pathLength == op.m_pathLength &&
+                        std::equal(path, path + depth, GetPath(m_ops[reservedUntil + 1]))
+                    ) {
+                        ++reservedUntil;
+                    }
+                    node->ReserveChildren(childCount + reservedUntil - o + 1);
+                }
+
+                const DataNode & value = m_values[op.m_value];
+                mutator.InsertChild(last).ToChild(last);
+                mutator.WriteNode(value);
+                mutator.WriteName(value.GetName());
+                mutator.PopNode();
+            } break;
+
+            case Op::Kind::Remove: {
+                if (last >= childCount)
+                    return false;
+                mutator.DeleteChild(last);
+            } break;
+
+            case Op::Kind::Move: {
+                if (last >= childCount || op.m_toIndex >= childCount)
+                    return false;
+                mutator.MoveChild(last, op.m_toIndex);
+            } break;
+
+            case Op::Kind::Replace: {
+                mutator.WriteNode(m_values[op.m_value]);
+            } break;
+        }
+    }
+
+    return true;
+}
+
+//=========================================================================
+void DataPatch::Clear (void) {
+    m_ops.clear();
+    m_pathIndices.clear();
+    m_values.clear();
+}
+
+//=========================================================================
+void DataPatch::Diff (const DataNode & from, const DataNode & to) {
+    Clear();
+    m_path.clear();
+    DiffNode(from, to);
+}
+
+//=========================================================================
+void DataPatch::DiffChildren (const DataNode & from, const DataNode & to) {
+    const int  fromCount = from.GetChildCount();
+    const int  toCount   = to.GetChildCount();
+    const bool byContent = to.GetType() == DataNode::Type::Array;
+
+    // match up the children: Object children by name, Array children by name
+    //  and contents.
+    std::vector<std::pair<std::uint64_t, int>> fromKeys;
+    fromKeys.reserve(fromCount);
+    for (int i = 0;  i < fromCount;  ++i)
+        fromKeys.push_back(std::make_pair(GetMatchKey(*from.GetChildFast(i), byContent), i));
+    std::sort(fromKeys.begin(), fromKeys.end());
+
+    std::vector<int> fromMatch(fromCount, -1);
+    std::vector<int> toMatch(toCount, -1);
+    for (int j = 0;  j < toCount;  ++j) {
+        const DataNode & toChild = *to.GetChildFast(j);
+        const std::uint64_t key = GetMatchKey(toChild, byContent);
+
+        std::vector<std::pair<std::uint64_t, int>>::const_iterator it =
+            std::lower_bound(fromKeys.begin(), fromKeys.end(), std::make_pair(key, -1));
+        for (;  it != fromKeys.end() && it->first == key;  ++it) {
+            const int i = it->second;
+            if (fromMatch[i] < 0 && std::strcmp(from.GetChildFast(i)->GetName(), toChild.GetName()) == 0) {
+                fromMatch[i] = j;
+                toMatch[j]   = i;
+                break;
+            }
+        }
+    }
+
+    // Array children which changed but kept their place: pair up whatever's
+    //  left, in order, so they're patched rather than removed and re-added.
+    if (byContent) {
+        int i = 0;
+        for (int j = 0;  j < toCount;  ++j) {
+            if (toMatch[j] >= 0)
+                continue;
+            while (i < fromCount && fromMatch[i] >= 0)
+                ++i;
+            if (i == fromCount)
+                break;
+            if (std::strcmp(from.GetChildFast(i)->GetName(), to.GetChildFast(j)->GetName()) == 0) {
+                fromMatch[i] = j;
+                toMatch[j]   = i;
+            }
+            ++i;
+        }
+    }
+
+    // the kept children, in their current order, as indices into to.  Those
+    //  on a longest increasing run stay put; the rest must move.
+    std::vector<int> order;
+    order.reserve(fromCount);
+    int removeCount = 0;
+    for (int i = 0;  i < fromCount;  ++i) {
+        if (fromMatch[i] >= 0)
+            order.push_back(fromMatch[i]);
+        else
+            ++removeCount;
+    }
+
+    std::vector<char> stays(toCount, 0);
+    const int moveCount = int(order.size()) - MarkLongestIncreasing(order, &stays);
+    const int addCount  = toCount - int(order.size());
+
+    if (removeCount + moveCount + addCount >= toCount) {
+        AddOp(Op::Kind::Replace, -1, -1, &to);
+        return;
+    }
+
+    for (int i = fromCount - 1;  i >= 0;  --i) {
+        if (fromMatch[i] < 0)
+            AddOp(Op::Kind::Remove, i, -1, nullptr);
+    }
+
+    // move each child that must, in to's order, to just after the one which
+    //  comes before it in to.  That one is already in place by then.
+    int previous = -1;
+    for (int j = 0;  j < toCount;  ++j) {
+        if (toMatch[j] < 0)
+            continue;
+
+        if (!stays[j]) {
+            const int position = int(std::find(order.begin(), order.end(), j) - order.begin());
+            int       target   = 0;
+            if (previous >= 0) {
+                const int previousPosition = int(std::find(order.begin(), order.end(), previous) - order.begin());
+                target = position < previousPosition ? previousPosition : previousPosition + 1;
+            }
+
+            if (position != target) {
+                AddOp(Op::Kind::Move, position, target, nullptr);
+                if (position < target)
+                    std::rotate(order.begin() + position, order.begin() + position + 1, order.begin() + target + 1);
+                else
+                    std::rotate(order.begin() + target, order.begin() + position, order.begin() + position + 1);
+            }
+        }
+        previous = j;
+    }
+
+    for (int j = 0;  j < toCount;  ++j) {
+        if (toMatch[j] < 0)
+            AddOp(Op::Kind::Add, j, -1, to.GetChildFast(j));
+    }
+
+    for (int j = 0;  j < toCount;  ++j) {
+        if (toMatch[j] < 0)
+            continue;
+        m_path.push_back(j);
+        DiffNode(*from.GetChildFast(toMatch[j]), *to.GetChildFast(j));
+        m_path.pop_back();
+    }
+}
+
+//=========================================================================
+void DataPatch::DiffNode (const DataNode & from, const DataNode & to) {
+    if (from.GetSubtreeHash() == to.GetSubtreeHash())
+        return;
+
+    if (from.GetType() != to.GetType() || !to.IsContainerType()) {
+        AddOp(Op::Kind::Replace, -1, -1, &to);
+        return;
+    }
+
+    DiffChildren(from, to);
+}
+
+} // namespace CSaruDataMap
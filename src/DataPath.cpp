@@ -0,0 +1,158 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <climits>
+#include <cstring>
+
+#include "exported/DataPath.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+DataPath::DataPath (void)
+    : m_valid(true)
+    , m_cachedBase()
+    , m_cachedVersion(0)
+    , m_cachedNode(nullptr)
+{}
+
+//=========================================================================
+DataPath::DataPath (const char * path)
+    : m_valid(false)
+    , m_cachedBase()
+    , m_cachedVersion(0)
+    , m_cachedNode(nullptr)
+{
+    Compile(path);
+}
+
+//=========================================================================
+bool DataPath::Compile (const char * path) {
+    Invalidate();
+    m_steps.clear();
+    m_valid = false;
+
+    if (path == nullptr)
+        return false;
+
+    const char * c = path;
+    while (*c) {
+        // a name, unless this part starts straight off with an index
+        if (*c != '[') {
+            Step step;
+            step.m_index = -1;
+            int nameLen = 0;
+            while (*c && *c != '.' && *c != '[' && *c != ']') {
+                if (nameLen >= int(DataNode::s_nameSize) - 1) {
+                    m_steps.clear();
+                    return false;
+                }
+                step.m_name[nameLen++] = *c++;
+            }
+            if (nameLen == 0 || *c == ']') {
+                m_steps.clear();
+                return false;
+            }
+            step.m_name[nameLen] = '\0';
+            m_steps.push_back(step);
+        }
+
+        // any number of indices
+        while (*c == '[') {
+            ++c;
+            if (*c < '0' || *c > '9') {
+                m_steps.clear();
+                return false;
+            }
+            // no index past INT_MAX
+            long long index = 0;
+            while (*c >= '0' && *c <= '9') {
+                index = index * 10 + (*c++ - '0');
+                if (index > INT_MAX) {
+                    m_steps.clear();
+                    return false;
+                }
+            }
+            if (*c++ != ']') {
+                m_steps.clear();
+                return false;
+            }
+
+            Step step;
+            step.m_index   = int(index);
+            step.m_name[0] = '\0';
+            m_steps.push_back(step);
+        }
+
+        if (*c == '.') {
+            ++c;
+            // no empty names, and no trailing '.'
+            if (*c == '\0' || *c == '.') {
+                m_steps.clear();
+                return false;
+            }
+        }
+        else if (*c != '\0') {
+            m_steps.clear();
+            return false;
+        }
+    }
+
+    m_valid = true;
+    return true;
+}
+
+//=========================================================================
+const DataNode * DataPath::Resolve (const DataNode * base) const {
+    if (base == nullptr || !m_valid) {
+        Invalidate();
+        return nullptr;
+    }
+
+    // the handle is bookkeeping, not part of the tree's contents.
+    const DataNodeHandle handle = const_cast<DataNode *>(base)->GetHandle();
+    if (handle == m_cachedBase && base->GetStructureVersion() == m_cachedVersion)
+        return m_cachedNode;
+
+    m_cachedBase    = handle;
+    m_cachedVersion = base->GetStructureVersion();
+    m_cachedIndices.clear();
+
+    const DataNode * node = base;
+    const int stepCount = int(m_steps.size());
+    for (int i = 0;  i < stepCount && node;  ++i) {
+        const Step & step = m_steps[i];
+        node = step.m_index < 0 ? node->GetChildByName(step.m_name) : node->GetChildSafe(step.m_index);
+        if (node)
+            m_cachedIndices.push_back(node->GetIndexInParent());
+    }
+
+    m_cachedNode = node;
+    return node;
+}
+
+//=========================================================================
+void DataPath::Invalidate (void) const {
+    m_cachedBase = DataNodeHandle();
+    m_cachedNode = nullptr;
+    m_cachedIndices.clear();
+}
+
+} // namespace CSaruDataMap
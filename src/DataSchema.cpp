@@ -0,0 +1,469 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "exported/DataSchema.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+static bool Report (
+    DataSchema::Violation::Kind          kind,
+    const std::string &                  path,
+    std::vector<DataSchema::Violation> * outViolations
+) {
+    if (outViolations) {
+        DataSchema::Violation violation;
+        violation.m_kind = kind;
+        violation.m_path = path;
+        outViolations->push_back(violation);
+    }
+    return false;
+}
+
+//=========================================================================
+static void AppendName (std::string * path, const char * name) {
+    if (!path->empty())
+        path->push_back('.');
+    path->append(name);
+}
+
+//=========================================================================
+static void AppendIndex (std::string * path, int index) {
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "[%d]", index);
+    path->append(buffer);
+}
+
+//=========================================================================
+static bool ParseTypeName (const char * name, std::uint32_t * outTypeMask) {
+    struct TypeName {
+        const char *  m_name;
+        std::uint32_t m_mask;
+    };
+    static const TypeName s_typeNames[] = {
+        { "null",   DataSchema::TypeBit(DataNode::Type::Null) },
+        { "object", DataSchema::TypeBit(DataNode::Type::Object) },
+        { "array",  DataSchema::TypeBit(DataNode::Type::Array) },
+        { "bool",   DataSchema::TypeBit(DataNode::Type::Bool) },
+        { "int",    DataSchema::TypeBit(DataNode::Type::Int) },
+        { "float",  DataSchema::TypeBit(DataNode::Type::Float) },
+        { "number", DataSchema::TypeBit(DataNode::Type::Int) | DataSchema::TypeBit(DataNode::Type::Float) },
+        { "string", DataSchema::TypeBit(DataNode::Type::String) },
+        { "any",    DataSchema::s_anyType },
+    };
+
+    for (const TypeName & typeName : s_typeNames) {
+        if (std::strcmp(typeName.m_name, name) == 0) {
+            *outTypeMask |= typeName.m_mask;
+            return true;
+        }
+    }
+    return false;
+}
+
+//=========================================================================
+static bool QueryNumber (const DataNode & node, double * outNumber) {
+    if (node.GetType() == DataNode::Type::Int)
+        *outNumber = node.GetInt();
+    else if (node.GetType() == DataNode::Type::Float)
+        *outNumber = node.GetFloat();
+    else
+        return false;
+    return true;
+}
+
+//=========================================================================
+const char * DataSchema::GetKindName (Violation::Kind kind) {
+    switch (kind) {
+        case Violation::Kind::WrongType:     return "wrong type";
+        case Violation::Kind::MissingKey:    return "missing key";
+        case Violation::Kind::UnexpectedKey: return "unexpected key";
+        case Violation::Kind::OutOfRange:    return "out of range";
+    }
+    return "unknown";
+}
+
+//=========================================================================
+DataSchema::DataSchema (void)
+    : m_compiled(false)
+{
+    AddRule("");
+}
+
+//=========================================================================
+void DataSchema::Clear (void) {
+    m_rules.clear();
+    m_ruleFields.clear();
+    m_program.clear();
+    AddRule("");
+}
+
+//=========================================================================
+int DataSchema::AddRule (const char * name) {
+    Rule rule;
+    std::strncpy(rule.m_name, name, DataNode::s_nameSize - 1);
+    rule.m_name[DataNode::s_nameSize - 1] = '\0';
+    rule.m_nameHash   = DataKey::HashString(rule.m_name);
+    rule.m_typeMask   = s_anyType;
+    rule.m_flags      = s_flagAllowUnknown;
+    rule.m_min        = 0.0;
+    rule.m_max        = 0.0;
+    rule.m_firstField = 0;
+    rule.m_fieldCount = 0;
+    rule.m_elements   = -1;
+
+    m_rules.push_back(rule);
+    m_ruleFields.push_back(std::vector<int>());
+    m_compiled = false;
+    return int(m_rules.size()) - 1;
+}
+
+//=========================================================================
+void DataSchema::SetTypes (int rule, std::uint32_t typeMask) {
+    #ifdef _DEBUG
+        assert(rule >= 0 && rule < int(m_rules.size()) && "DataSchema::SetTypes() called with an invalid rule.");
+    #endif
+    m_rules[rule].m_typeMask = typeMask;
+    m_compiled = false;
+}
+
+//=========================================================================
+int DataSchema::AddField (int objectRule, const char * name, std::uint32_t typeMask, bool required) {
+    #ifdef _DEBUG
+        assert(objectRule >= 0 && objectRule < int(m_rules.size()) && "DataSchema::AddField() called with an invalid rule.");
+    #endif
+    const int field = AddRule(name);
+    m_rules[field].m_typeMask = typeMask;
+    if (required)
+        m_rules[field].m_flags |= s_flagRequired;
+    m_ruleFields[objectRule].push_back(field);
+    return field;
+}
+
+//=========================================================================
+int DataSchema::SetElements (int arrayRule, std::uint32_t typeMask) {
+    #ifdef _DEBUG
+        assert(arrayRule >= 0 && arrayRule < int(m_rules.size()) && "DataSchema::SetElements() called with an invalid rule.");
+    #endif
+    int elements = m_rules[arrayRule].m_elements;
+    if (elements < 0) {
+        elements = AddRule("");
+        m_rules[arrayRule].m_elements = elements;
+    }
+    m_rules[elements].m_typeMask = typeMask;
+    m_compiled = false;
+    return elements;
+}
+
+//=========================================================================
+void DataSchema::SetRange (int rule, double min, double max) {
+    SetMin(rule, min);
+    SetMax(rule, max);
+}
+
+//=========================================================================
+void DataSchema::SetMin (int rule, double min) {
+    #ifdef _DEBUG
+        assert(rule >= 0 && rule < int(m_rules.size()) && "DataSchema::SetMin() called with an invalid rule.");
+    #endif
+    m_rules[rule].m_min    = min;
+    m_rules[rule].m_flags |= s_flagHasMin;
+    m_compiled = false;
+}
+
+//=========================================================================
+void DataSchema::SetMax (int rule, double max) {
+    #ifdef _DEBUG
+        assert(rule >= 0 && rule < int(m_rules.size()) && "DataSchema::SetMax() called with an invalid rule.");
+    #endif
+    m_rules[rule].m_max    = max;
+    m_rules[rule].m_flags |= s_flagHasMax;
+    m_compiled = false;
+}
+
+//=========================================================================
+void DataSchema::SetAllowUnknownKeys (int rule, bool allow) {
+    #ifdef _DEBUG
+        assert(rule >= 0 && rule < int(m_rules.size()) && "DataSchema::SetAllowUnknownKeys() called with an invalid rule.");
+    #endif
+    if (allow)
+        m_rules[rule].m_flags |= s_flagAllowUnknown;
+    else
+        m_rules[rule].m_flags &= ~s_flagAllowUnknown;
+    m_compiled = false;
+}
+
+//=========================================================================
+bool DataSchema::LoadFromNode (const DataNode & schemaNode) {
+    Clear();
+    if (!LoadRule(GetRootRule(), schemaNode)) {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+//=========================================================================
+bool DataSchema::LoadRule (int ruleIndex, const DataNode & ruleNode) {
+    if (ruleNode.GetType() != DataNode::Type::Object)
+        return false;
+
+    const int childCount = ruleNode.GetChildCount();
+    for (int c = 0;  c < childCount;  ++c) {
+        const DataNode & child = *ruleNode.GetChildFast(c);
+        const char *     key   = child.GetName();
+
+        if (std::strcmp(key, "type") == 0) {
+            std::uint32_t typeMask = 0;
+            if (child.GetType() == DataNode::Type::String) {
+                if (!ParseTypeName(child.GetString(), &typeMask))
+                    return false;
+            }
+            else if (child.GetType() == DataNode::Type::Array) {
+                for (int t = 0;  t < child.GetChildCount();  ++t) {
+                    const DataNode & typeNode = *child.GetChildFast(t);
+                    if (typeNode.GetType() != DataNode::Type::String || !ParseTypeName(typeNode.GetString(), &typeMask))
+                        return false;
+                }
+            }
+            else
+                return false;
+            SetTypes(ruleIndex, typeMask);
+        }
+        else if (std::strcmp(key, "required") == 0) {
+            bool required;
+            if (!child.QueryBool(&required))
+                return false;
+            if (required)
+                m_rules[ruleIndex].m_flags |= s_flagRequired;
+            else
+                m_rules[ruleIndex].m_flags &= ~s_flagRequired;
+        }
+        else if (std::strcmp(key, "min") == 0 || std::strcmp(key, "max") == 0) {
+            double number;
+            if (!QueryNumber(child, &number))
+                return false;
+            if (key[1] == 'i')
+                SetMin(ruleIndex, number);
+            else
+                SetMax(ruleIndex, number);
+        }
+        else if (std::strcmp(key, "allowUnknown") == 0) {
+            bool allow;
+            if (!child.QueryBool(&allow))
+                return false;
+            SetAllowUnknownKeys(ruleIndex, allow);
+        }
+        else if (std::strcmp(key, "fields") == 0) {
+            if (child.GetType() != DataNode::Type::Object)
+                return false;
+            for (int f = 0;  f < child.GetChildCount();  ++f) {
+                const DataNode & fieldNode = *child.GetChildFast(f);
+                const int        field     = AddField(ruleIndex, fieldNode.GetName(), s_anyType, true);
+                if (!LoadRule(field, fieldNode))
+                    return false;
+            }
+        }
+        else if (std::strcmp(key, "elements") == 0) {
+            if (!LoadRule(SetElements(ruleIndex, s_anyType), child))
+                return false;
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
+
+//=========================================================================
+void DataSchema::Compile (void) {
+    m_program.clear();
+    m_program.reserve(m_rules.size());
+
+    // Breadth-first, so that each rule's fields end up side by side.
+    //  sourceRules[i] is the built rule which compiled to m_program[i].
+    std::vector<int> sourceRules;
+    sourceRules.reserve(m_rules.size());
+    sourceRules.push_back(GetRootRule());
+    m_program.push_back(m_rules[GetRootRule()]);
+
+    for (std::size_t slot = 0;  slot < sourceRules.size();  ++slot) {
+        const int        source = sourceRules[slot];
+        std::vector<int> fields = m_ruleFields[source];
+        std::sort(fields.begin(), fields.end(), [this](int a, int b) {
+            return m_rules[a].m_nameHash < m_rules[b].m_nameHash;
+        });
+
+        m_program[slot].m_firstField = int(m_program.size());
+        m_program[slot].m_fieldCount = int(fields.size());
+        for (int field : fields) {
+            sourceRules.push_back(field);
+            m_program.push_back(m_rules[field]);
+        }
+
+        const int elements = m_rules[source].m_elements;
+        if (elements >= 0) {
+            m_program[slot].m_elements = int(m_program.size());
+            sourceRules.push_back(elements);
+            m_program.push_back(m_rules[elements]);
+        }
+    }
+
+    m_compiled = true;
+}
+
+//=========================================================================
+bool DataSchema::Validate (const DataNode & node, std::vector<Violation> * outViolations) const {
+    #ifdef _DEBUG
+        assert(m_compiled && "DataSchema::Validate() called before DataSchema::Compile().");
+    #endif
+    if (!m_compiled)
+        return false;
+
+    std::string path;
+    return ValidateNode(GetRootRule(), node, &path, outViolations);
+}
+
+//=========================================================================
+bool DataSchema::ValidateNode (
+    int                      ruleIndex,
+    const DataNode &         node,
+    std::string *            path,
+    std::vector<Violation> * outViolations
+) const {
+    const Rule &         rule = m_program[ruleIndex];
+    const DataNode::Type type = node.GetType();
+
+    if (!(rule.m_typeMask & TypeBit(type)))
+        return Report(Violation::Kind::WrongType, *path, outViolations);
+
+    bool ok = true;
+
+    if (rule.m_flags & (s_flagHasMin | s_flagHasMax)) {
+        double value  = 0.0;
+        bool   ranged = true;
+        switch (type) {
+            case DataNode::Type::Int:    value = node.GetInt();                   break;
+            case DataNode::Type::Float:  value = node.GetFloat();                 break;
+            case DataNode::Type::String: value = double(std::strlen(node.GetString())); break;
+            case DataNode::Type::Object:
+            case DataNode::Type::Array:  value = node.GetChildCount();            break;
+            default:                     ranged = false;                          break;
+        }
+
+        if (ranged &&
+            (((rule.m_flags & s_flagHasMin) && value < rule.m_min) ||
+             ((rule.m_flags & s_flagHasMax) && value > rule.m_max))
+        ) {
+            ok = Report(Violation::Kind::OutOfRange, *path, outViolations);
+            if (!outViolations)
+                return false;
+        }
+    }
+
+    if (!node.IsContainerType())
+        return ok;
+
+    const std::size_t pathLength = path->size();
+    const int         childCount = node.GetChildCount();
+
+    if (type == DataNode::Type::Object && (rule.m_fieldCount > 0 || !(rule.m_flags & s_flagAllowUnknown))) {
+        const Rule * fieldsBegin = m_program.data() + rule.m_firstField;
+        const Rule * fieldsEnd   = fieldsBegin + rule.m_fieldCount;
+
+        // which fields have been matched; only the first child of a name counts.
+        std::uint64_t     seenBits = 0;
+        std::vector<bool> seenMany;
+        if (rule.m_fieldCount > 64)
+            seenMany.resize(rule.m_fieldCount, false);
+
+        for (int c = 0;  c < childCount;  ++c) {
+            const DataNode &    child = *node.GetChildFast(c);
+            const std::uint32_t hash  = child.GetNameHash();
+
+            const Rule * field = std::lower_bound(fieldsBegin, fieldsEnd, hash, [](const Rule & lhs, std::uint32_t rhs) {
+                return lhs.m_nameHash < rhs;
+            });
+            while (field != fieldsEnd && field->m_nameHash == hash && std::strcmp(field->m_name, child.GetName()) != 0)
+                ++field;
+
+            AppendName(path, child.GetName());
+
+            if (field != fieldsEnd && field->m_nameHash == hash) {
+                const int fieldIndex = int(field - fieldsBegin);
+                bool      seen;
+                if (rule.m_fieldCount > 64) {
+                    seen = seenMany[fieldIndex];
+                    seenMany[fieldIndex] = true;
+                }
+                else {
+                    seen = (seenBits & (std::uint64_t(1) << fieldIndex)) != 0;
+                    seenBits |= std::uint64_t(1) << fieldIndex;
+                }
+
+                if (!seen && !ValidateNode(rule.m_firstField + fieldIndex, child, path, outViolations)) {
+                    ok = false;
+                    if (!outViolations)
+                        return false;
+                }
+            }
+            else if (!(rule.m_flags & s_flagAllowUnknown)) {
+                ok = Report(Violation::Kind::UnexpectedKey, *path, outViolations);
+                if (!outViolations)
+                    return false;
+            }
+
+            path->resize(pathLength);
+        }
+
+        for (int f = 0;  f < rule.m_fieldCount;  ++f) {
+            const bool seen = rule.m_fieldCount > 64 ? seenMany[f] : (seenBits & (std::uint64_t(1) << f)) != 0;
+            if (seen || !(fieldsBegin[f].m_flags & s_flagRequired))
+                continue;
+
+            AppendName(path, fieldsBegin[f].m_name);
+            ok = Report(Violation::Kind::MissingKey, *path, outViolations);
+            path->resize(pathLength);
+            if (!outViolations)
+                return false;
+        }
+    }
+
+    if (rule.m_elements >= 0) {
+        for (int c = 0;  c < childCount;  ++c) {
+            AppendIndex(path, c);
+            if (!ValidateNode(rule.m_elements, *node.GetChildFast(c), path, outViolations)) {
+                ok = false;
+                if (!outViolations)
+                    return false;
+            }
+            path->resize(pathLength);
+        }
+    }
+
+    return ok;
+}
+
+} // namespace CSaruDataMap
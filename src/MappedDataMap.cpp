@@ -0,0 +1,1060 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "exported/DataKey.hpp"
+#include "exported/MappedDataMap.hpp"
+
+#define MAPPEDDATAMAP_BASIC_SAFETY_CHECKS 1
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// RETURNS: log2 of the smallest power of two >= slots.
+static std::uint32_t GetSizeClass (std::uint32_t slots) {
+    std::uint32_t sizeClass = 0;
+    while (sizeClass < 31 && (std::uint32_t(1) << sizeClass) < slots)
+        ++sizeClass;
+    return sizeClass;
+}
+
+//=========================================================================
+static std::uint32_t GetChildCapacity (std::uint32_t childCount) {
+    return childCount ? std::uint32_t(1) << GetSizeClass(childCount) : 0;
+}
+
+//=========================================================================
+static std::uint32_t GetStringSlots (std::size_t length) {
+    return std::uint32_t((length + 1 + MappedDataMap::s_slotSize - 1) / MappedDataMap::s_slotSize);
+}
+
+//=========================================================================
+static void InitNode (OffsetDataNode * node, std::uint32_t emptyString, DataNode::Type type) {
+    std::memset(node, 0, sizeof(*node));
+    node->m_nameOffset = emptyString;
+    node->m_nameHash   = DataKey::HashName("", 0);
+    node->m_type       = std::uint8_t(type);
+}
+
+//=========================================================================
+MappedDataMap::MappedDataMap (void)
+    : m_file(-1)
+    , m_base(nullptr)
+    , m_size(0)
+    , m_failed(false)
+{}
+
+//=========================================================================
+MappedDataMap::~MappedDataMap () {
+    Close();
+}
+
+//=========================================================================
+std::uint32_t MappedDataMap::Allocate (std::uint32_t slots) {
+    Touch();
+
+    const std::uint32_t sizeClass = GetSizeClass(slots);
+    if (sizeClass >= s_classCount) {
+        m_failed = true;
+        return 0;
+    }
+
+    Header * header = GetHeader();
+    const std::uint32_t block = header->m_freeLists[sizeClass];
+    if (block) {
+        std::memcpy(&header->m_freeLists[sizeClass], m_base + std::size_t(block) * s_slotSize, sizeof(std::uint32_t));
+        return block;
+    }
+
+    const std::uint32_t  size = std::uint32_t(1) << sizeClass;
+    const std::uint64_t  end  = std::uint64_t(header->m_nextSlot) + size;
+    if (end > header->m_slotCount) {
+        if (end > s_maxSlots || !Grow(std::uint32_t(end))) {
+            m_failed = true;
+            return 0;
+        }
+        header = GetHeader();
+    }
+
+    const std::uint32_t newBlock = header->m_nextSlot;
+    header->m_nextSlot += size;
+    return newBlock;
+}
+
+//=========================================================================
+std::uint32_t MappedDataMap::AllocateString (const char * str, std::size_t length, std::size_t maxLength) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(maxLength < DataNode::s_stringDataSize && "MappedDataMap::AllocateString() called with too long a maxLength.");
+    #endif
+
+    if (length > maxLength)
+        length = maxLength;
+    if (length == 0)
+        return GetEmptyString();
+
+    // str may be in the mapping, which Allocate() may move.
+    char copy[DataNode::s_stringDataSize];
+    std::memcpy(copy, str, length);
+    copy[length] = '\0';
+
+    const std::uint32_t block = Allocate(GetStringSlots(length));
+    if (block == 0)
+        return 0;
+    std::memcpy(m_base + std::size_t(block) * s_slotSize, copy, length + 1);
+    return block * s_slotSize;
+}
+
+//=========================================================================
+bool MappedDataMap::Close (void) {
+    if (!IsOpen())
+        return true;
+
+    const bool result = Sync();
+    Unmap();
+    #ifndef _WIN32
+        close(m_file);
+    #endif
+    m_file = -1;
+    m_path.clear();
+    return result;
+}
+
+//=========================================================================
+bool MappedDataMap::CopyFrom (const DataNode & root) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsOpen() && "MappedDataMap::CopyFrom() called, but the map isn't open.");
+    #endif
+
+    const std::uint32_t rootIndex = GetHeader()->m_root;
+    if (SetName(rootIndex, root.GetName(), std::strlen(root.GetName())) && SetSubtree(rootIndex, root))
+        return true;
+
+    ResetValue(rootIndex, DataNode::Type::Object);
+    return false;
+}
+
+//=========================================================================
+void MappedDataMap::CopyTo (DataNode * outRoot) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsOpen() && "MappedDataMap::CopyTo() called, but the map isn't open.");
+    #endif
+
+    OffsetDataMapImage::ToDataNode(GetNodes(), GetString(0), outRoot, GetHeader()->m_root);
+}
+
+//=========================================================================
+void MappedDataMap::DeleteChild (std::uint32_t parent, std::uint32_t index) {
+    Touch();
+
+    OffsetDataNode *    nodes = GetNodes();
+    const std::uint32_t begin = nodes[parent].m_childBegin;
+    const std::uint32_t count = nodes[parent].m_childCount;
+
+    FreeString(nodes[begin + index].m_nameOffset);
+    FreeValue(begin + index);
+    std::memmove(&nodes[begin + index], &nodes[begin + index + 1], (count - index - 1) * sizeof(OffsetDataNode));
+
+    // the block halves whenever the count drops to a power of two.
+    const std::uint32_t newCount = count - 1;
+    if (newCount == 0) {
+        Free(begin, 1);
+        nodes[parent].m_childBegin = 0;
+    }
+    else if ((newCount & (newCount - 1)) == 0) {
+        Free(begin + newCount, newCount);
+    }
+    nodes[parent].m_childCount = newCount;
+}
+
+//=========================================================================
+std::uint32_t MappedDataMap::FindChild (std::uint32_t parent, const DataKey & key) const {
+    const OffsetDataNode * nodes = GetNodes();
+    const std::uint32_t    begin = nodes[parent].m_childBegin;
+    const std::uint32_t    end   = begin + nodes[parent].m_childCount;
+    for (std::uint32_t i = begin;  i < end;  ++i) {
+        if (nodes[i].m_nameHash == key.m_hash && key.MatchesName(GetString(nodes[i].m_nameOffset)))
+            return i;
+    }
+    return s_noNode;
+}
+
+//=========================================================================
+void MappedDataMap::Free (std::uint32_t block, std::uint32_t slots) {
+    Touch();
+
+    // free blocks are listed through their first four bytes.
+    Header * header = GetHeader();
+    const std::uint32_t sizeClass = GetSizeClass(slots);
+    std::memcpy(m_base + std::size_t(block) * s_slotSize, &header->m_freeLists[sizeClass], sizeof(std::uint32_t));
+    header->m_freeLists[sizeClass] = block;
+}
+
+//=========================================================================
+void MappedDataMap::FreeString (std::uint32_t offset) {
+    if (offset == GetEmptyString())
+        return;
+    Free(offset / s_slotSize, GetStringSlots(std::strlen(GetString(offset))));
+}
+
+//=========================================================================
+void MappedDataMap::FreeValue (std::uint32_t node) {
+    struct Block {
+        std::uint32_t m_begin;
+        std::uint32_t m_slots;
+    };
+
+    OffsetDataNode *           nodes = GetNodes();
+    std::vector<std::uint32_t> pending(1, node);
+    std::vector<Block>         blocks;
+    while (!pending.empty()) {
+        const OffsetDataNode & current = nodes[pending.back()];
+        if (pending.back() != node)
+            FreeString(current.m_nameOffset);
+        pending.pop_back();
+
+        if (current.GetType() == DataNode::Type::String)
+            FreeString(current.m_value);
+        if (current.m_childCount) {
+            blocks.push_back(Block{current.m_childBegin, GetChildCapacity(current.m_childCount)});
+            for (std::uint32_t c = 0;  c < current.m_childCount;  ++c)
+                pending.push_back(current.m_childBegin + c);
+        }
+    }
+
+    // not until every node in them has been read; freeing writes over them.
+    for (const Block & block : blocks)
+        Free(block.m_begin, block.m_slots);
+
+    nodes[node].m_value      = 0;
+    nodes[node].m_childBegin = 0;
+    nodes[node].m_childCount = 0;
+}
+
+//=========================================================================
+MappedDataMapMutator MappedDataMap::GetMutator (void) {
+    return MappedDataMapMutator(this);
+}
+
+//=========================================================================
+OffsetDataMapReader MappedDataMap::GetReader (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsOpen() && "MappedDataMap::GetReader() called, but the map isn't open.");
+    #endif
+
+    const Header * header = GetHeader();
+    return OffsetDataMapReader(GetNodes(), header->m_slotCount, GetString(0), std::uint32_t(m_size), header->m_root);
+}
+
+//=========================================================================
+bool MappedDataMap::Grow (std::uint32_t minSlots) {
+    #ifdef _WIN32
+        (void)minSlots;
+        return false;
+    #else
+        const std::uint32_t oldSlots = GetHeader()->m_slotCount;
+        std::uint64_t       newSlots = std::max(std::uint64_t(oldSlots) * 2, std::uint64_t(minSlots));
+        if (newSlots > s_maxSlots)
+            newSlots = s_maxSlots;
+        if (newSlots < minSlots)
+            return false;
+
+        const std::size_t oldSize = m_size;
+        const std::size_t newSize = std::size_t(newSlots) * s_slotSize;
+
+        // the new mapping is made before the file grows into it, and the old
+        //  one kept until both have worked, so a failure leaves the map as it
+        //  was.  Both are shared, so neither holds anything the other lacks.
+        std::uint8_t * const oldBase = m_base;
+        if (!Map(newSize))
+            return false;
+        if (ftruncate(m_file, off_t(newSize)) != 0) {
+            munmap(m_base, newSize);
+            m_base = oldBase;
+            m_size = oldSize;
+            return false;
+        }
+        munmap(oldBase, oldSize);
+
+        GetHeader()->m_slotCount = std::uint32_t(newSlots);
+        return true;
+    #endif
+}
+
+//=========================================================================
+std::uint32_t MappedDataMap::InsertChild (std::uint32_t parent, std::uint32_t index) {
+    OffsetDataNode *    nodes = GetNodes();
+    const std::uint32_t count = nodes[parent].m_childCount;
+
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(index <= count && "MappedDataMap::InsertChild() called with an invalid index.");
+    #endif
+
+    Touch();
+    std::uint32_t begin = nodes[parent].m_childBegin;
+    if (count == GetChildCapacity(count)) {
+        // full (or empty); move to a block twice the size.
+        const std::uint32_t newBegin = Allocate(count ? count * 2 : 1);
+        if (newBegin == 0)
+            return s_noNode;
+        nodes = GetNodes();
+
+        std::memcpy(&nodes[newBegin], &nodes[begin], index * sizeof(OffsetDataNode));
+        std::memcpy(&nodes[newBegin + index + 1], &nodes[begin + index], (count - index) * sizeof(OffsetDataNode));
+        if (count)
+            Free(begin, count);
+        begin = newBegin;
+        nodes[parent].m_childBegin = begin;
+    }
+    else {
+        std::memmove(&nodes[begin + index + 1], &nodes[begin + index], (count - index) * sizeof(OffsetDataNode));
+    }
+
+    OffsetDataNode & parentNode = nodes[parent];
+    if (!parentNode.IsContainerType()) {
+        if (parentNode.GetType() == DataNode::Type::String)
+            FreeString(parentNode.m_value);
+        parentNode.m_value = 0;
+        parentNode.m_type  = std::uint8_t(DataNode::Type::Object);
+    }
+    parentNode.m_childCount = count + 1;
+
+    InitNode(&nodes[begin + index], GetEmptyString(), DataNode::Type::Unused);
+    return begin + index;
+}
+
+//=========================================================================
+bool MappedDataMap::Map (std::size_t size) {
+    #ifdef _WIN32
+        (void)size;
+        return false;
+    #else
+        void * base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+        if (base == MAP_FAILED)
+            return false;
+
+        m_base = static_cast<std::uint8_t *>(base);
+        m_size = size;
+        return true;
+    #endif
+}
+
+//=========================================================================
+void MappedDataMap::MoveChild (std::uint32_t parent, std::uint32_t fromIndex, std::uint32_t toIndex) {
+    Touch();
+
+    OffsetDataNode * children = GetNodes() + GetNodes()[parent].m_childBegin;
+    if (fromIndex < toIndex)
+        std::rotate(children + fromIndex, children + fromIndex + 1, children + toIndex + 1);
+    else if (toIndex < fromIndex)
+        std::rotate(children + toIndex, children + fromIndex, children + fromIndex + 1);
+}
+
+//=========================================================================
+bool MappedDataMap::Open (const char * path) {
+    #ifdef _WIN32
+        (void)path;
+        return false;
+    #else
+        Close();
+        m_failed = false;
+
+        m_file = open(path, O_RDWR | O_CREAT, 0644);
+        if (m_file < 0)
+            return false;
+
+        struct stat status;
+        bool        result = fstat(m_file, &status) == 0;
+        if (result && status.st_size == 0) {
+            // a new file.
+            result = ftruncate(m_file, off_t(s_initialSlots) * s_slotSize) == 0 && Map(std::size_t(s_initialSlots) * s_slotSize);
+            if (result) {
+                Header * header = GetHeader();
+                std::memset(m_base, 0, std::size_t(s_headerSlots) * s_slotSize);
+                header->m_magic     = s_magic;
+                header->m_slotCount = s_initialSlots;
+                header->m_nextSlot  = s_headerSlots;
+                header->m_dirty     = 1;
+                header->m_root      = Allocate(1);
+                InitNode(&GetNodes()[header->m_root], GetEmptyString(), DataNode::Type::Object);
+                result = Sync();
+            }
+        }
+        else if (result) {
+            const std::uint64_t size = std::uint64_t(status.st_size);
+            result =
+                size % s_slotSize == 0 &&
+                size >= std::uint64_t(s_headerSlots) * s_slotSize &&
+                size <= std::uint64_t(s_maxSlots) * s_slotSize &&
+                Map(std::size_t(size));
+
+            if (result) {
+                const Header * header = GetHeader();
+                result =
+                    header->m_magic == s_magic &&
+                    std::uint64_t(header->m_slotCount) * s_slotSize == size &&
+                    header->m_nextSlot >= s_headerSlots &&
+                    header->m_nextSlot <= header->m_slotCount &&
+                    header->m_root >= s_headerSlots &&
+                    header->m_root < header->m_nextSlot;
+            }
+
+            if (result && GetHeader()->m_dirty)
+                result = Recover();
+        }
+
+        if (!result) {
+            Unmap();
+            close(m_file);
+            m_file = -1;
+            return false;
+        }
+
+        m_path = path;
+        return true;
+    #endif
+}
+
+//=========================================================================
+bool MappedDataMap::Recover (void) {
+    Header *            header   = GetHeader();
+    OffsetDataNode *    nodes    = GetNodes();
+    const std::uint32_t nextSlot = header->m_nextSlot;
+    std::vector<bool>   used(nextSlot, false);
+
+    // RETURNS: false if the block is out of range, or overlaps another.
+    auto mark = [&](std::uint32_t block, std::uint32_t slots) -> bool {
+        if (block < s_headerSlots || std::uint64_t(block) + slots > nextSlot)
+            return false;
+        for (std::uint32_t i = block;  i < block + slots;  ++i) {
+            if (used[i])
+                return false;
+            used[i] = true;
+        }
+        return true;
+    };
+    auto markString = [&](std::uint32_t offset, std::size_t maxLength) -> bool {
+        if (offset == GetEmptyString())
+            return true;
+        if (offset % s_slotSize || offset / s_slotSize < s_headerSlots || offset / s_slotSize >= nextSlot)
+            return false;
+        const char * str = GetString(offset);
+        const void * end = std::memchr(str, '\0', std::size_t(nextSlot) * s_slotSize - offset);
+        if (end == nullptr)
+            return false;
+        const std::size_t length = std::size_t(static_cast<const char *>(end) - str);
+        return length <= maxLength && mark(offset / s_slotSize, std::uint32_t(1) << GetSizeClass(GetStringSlots(length)));
+    };
+
+    // every block the tree uses gets marked once; a block reached twice
+    //  means the tree is broken (and may have a cycle).
+    if (!mark(header->m_root, 1))
+        return false;
+    std::vector<std::uint32_t> pending(1, header->m_root);
+    while (!pending.empty()) {
+        OffsetDataNode & node = nodes[pending.back()];
+        pending.pop_back();
+
+        if (node.m_type > std::uint8_t(DataNode::Type::String) || !markString(node.m_nameOffset, DataNode::s_nameSize - 1))
+            return false;
+        node.m_nameHash = DataKey::HashString(GetString(node.m_nameOffset));
+
+        if (node.GetType() == DataNode::Type::String && !markString(node.m_value, DataNode::s_stringDataSize - 1))
+            return false;
+        if (node.m_childCount) {
+            if (!node.IsContainerType() || !mark(node.m_childBegin, GetChildCapacity(node.m_childCount)))
+                return false;
+            for (std::uint32_t c = 0;  c < node.m_childCount;  ++c)
+                pending.push_back(node.m_childBegin + c);
+        }
+    }
+
+    // everything else below m_nextSlot is free; list it in the largest
+    //  blocks that fit.
+    std::memset(header->m_freeLists, 0, sizeof(header->m_freeLists));
+    std::uint32_t slot = s_headerSlots;
+    while (slot < nextSlot) {
+        if (used[slot]) {
+            ++slot;
+            continue;
+        }
+
+        std::uint32_t end = slot;
+        while (end < nextSlot && !used[end])
+            ++end;
+        while (slot < end) {
+            std::uint32_t sizeClass = GetSizeClass(end - slot);
+            if ((std::uint32_t(1) << sizeClass) > end - slot)
+                --sizeClass;
+            sizeClass = std::min(sizeClass, s_classCount - 1);
+            Free(slot, std::uint32_t(1) << sizeClass);
+            slot += std::uint32_t(1) << sizeClass;
+        }
+    }
+
+    return true;
+}
+
+//=========================================================================
+void MappedDataMap::ResetValue (std::uint32_t node, DataNode::Type type) {
+    Touch();
+    FreeValue(node);
+    GetNodes()[node].m_type = std::uint8_t(type);
+}
+
+//=========================================================================
+bool MappedDataMap::SetName (std::uint32_t node, const char * name, std::size_t length) {
+    const std::uint32_t offset = AllocateString(name, length, DataNode::s_nameSize - 1);
+    if (offset == 0)
+        return false;
+
+    Touch();
+    OffsetDataNode & target = GetNodes()[node];
+    const std::uint32_t oldOffset = target.m_nameOffset;
+    target.m_nameOffset = offset;
+    target.m_nameHash   = DataKey::HashString(GetString(offset));
+    FreeString(oldOffset);
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMap::SetString (std::uint32_t node, const char * str, std::size_t length) {
+    const std::uint32_t offset = AllocateString(str, length, DataNode::s_stringDataSize - 1);
+    if (offset == 0)
+        return false;
+
+    ResetValue(node, DataNode::Type::String);
+    GetNodes()[node].m_value = offset;
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMap::SetSubtree (std::uint32_t node, const DataNode & source) {
+    struct Step {
+        std::uint32_t    m_node;
+        const DataNode * m_source;
+    };
+
+    ResetValue(node, DataNode::Type::Null);
+    std::vector<Step> steps(1, Step{node, &source});
+    while (!steps.empty()) {
+        const Step step = steps.back();
+        steps.pop_back();
+
+        const DataNode & from = *step.m_source;
+        switch (from.GetType()) {
+            case DataNode::Type::Bool:  GetNodes()[step.m_node].m_value = from.GetBool() ? 1 : 0;       break;
+            case DataNode::Type::Int:   GetNodes()[step.m_node].m_value = std::uint32_t(from.GetInt()); break;
+            case DataNode::Type::Float: {
+                const float value = from.GetFloat();
+                std::memcpy(&GetNodes()[step.m_node].m_value, &value, sizeof(value));
+            } break;
+            case DataNode::Type::String: {
+                const std::uint32_t offset = AllocateString(from.GetString(), std::strlen(from.GetString()), DataNode::s_stringDataSize - 1);
+                if (offset == 0)
+                    return false;
+                GetNodes()[step.m_node].m_value = offset;
+            } break;
+
+            case DataNode::Type::Object:
+            case DataNode::Type::Array: {
+                const std::uint32_t count = std::uint32_t(from.GetChildCount());
+                if (count == 0)
+                    break;
+                const std::uint32_t begin = Allocate(count);
+                if (begin == 0)
+                    return false;
+
+                for (std::uint32_t c = 0;  c < count;  ++c)
+                    InitNode(&GetNodes()[begin + c], GetEmptyString(), DataNode::Type::Null);
+                GetNodes()[step.m_node].m_childBegin = begin;
+                GetNodes()[step.m_node].m_childCount = count;
+
+                for (std::uint32_t c = 0;  c < count;  ++c) {
+                    const DataNode * child = from.GetChildFast(int(c));
+                    if (!SetName(begin + c, child->GetName(), std::strlen(child->GetName())))
+                        return false;
+                    steps.push_back(Step{begin + c, child});
+                }
+            } break;
+
+            default: break;
+        }
+
+        // the type goes in last, so a String never points at nothing.
+        GetNodes()[step.m_node].m_type = std::uint8_t(from.GetType());
+    }
+
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMap::Sync (void) {
+    #ifdef _WIN32
+        return false;
+    #else
+        if (!IsOpen())
+            return false;
+
+        // everything else first, so the file is never marked clean before
+        //  the changes it's clean with are written.
+        if (msync(m_base, m_size, MS_SYNC) != 0)
+            return false;
+        GetHeader()->m_dirty = 0;
+        const std::size_t headerSize = std::min(m_size, std::size_t(sysconf(_SC_PAGESIZE)));
+        if (msync(m_base, headerSize, MS_SYNC) != 0)
+            return false;
+
+        return !m_failed;
+    #endif
+}
+
+//=========================================================================
+void MappedDataMap::Touch (void) {
+    Header * header = GetHeader();
+    if (header->m_dirty)
+        return;
+
+    // written through at once, or a crash could leave the file looking
+    //  synced with some of the changes after it on disk.
+    header->m_dirty = 1;
+    #ifndef _WIN32
+        msync(m_base, std::min(m_size, std::size_t(sysconf(_SC_PAGESIZE))), MS_SYNC);
+    #endif
+}
+
+//=========================================================================
+void MappedDataMap::Unmap (void) {
+    #ifndef _WIN32
+        if (m_base)
+            munmap(m_base, m_size);
+    #endif
+    m_base = nullptr;
+    m_size = 0;
+}
+
+//=========================================================================
+MappedDataMapMutator::MappedDataMapMutator (MappedDataMap * map)
+    : m_map(map)
+    , m_node(map->IsOpen() ? map->GetRootIndex() : MappedDataMap::s_noNode)
+{}
+
+//=========================================================================
+void MappedDataMapMutator::DeleteChild (int index) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::DeleteChild() called, but the Mutator is invalid.");
+        assert(index >= 0 && index < GetChildCount() && "MappedDataMapMutator::DeleteChild() called with an invalid index.");
+    #endif
+
+    m_map->DeleteChild(m_node, std::uint32_t(index));
+}
+
+//=========================================================================
+void MappedDataMapMutator::DeleteLastChildren (int count) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::DeleteLastChildren() called, but the Mutator is invalid.");
+    #endif
+
+    for (int i = 0;  i < count && GetNode().m_childCount;  ++i)
+        m_map->DeleteChild(m_node, GetNode().m_childCount - 1);
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::InsertChild (int index) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::InsertChild() called, but the Mutator is invalid.");
+        assert(index >= 0 && index <= GetChildCount() && "MappedDataMapMutator::InsertChild() called with an invalid index.");
+    #endif
+
+    const std::uint32_t child = m_map->InsertChild(m_node, std::uint32_t(index));
+    if (child != MappedDataMap::s_noNode)
+        m_map->GetNodes()[child].m_type = std::uint8_t(DataNode::Type::Null);
+    return *this;
+}
+
+//=========================================================================
+void MappedDataMapMutator::MoveChild (int fromIndex, int toIndex) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::MoveChild() called, but the Mutator is invalid.");
+        assert(fromIndex >= 0 && fromIndex < GetChildCount() && "MappedDataMapMutator::MoveChild() called with an invalid fromIndex.");
+        assert(toIndex >= 0 && toIndex < GetChildCount() && "MappedDataMapMutator::MoveChild() called with an invalid toIndex.");
+    #endif
+
+    m_map->MoveChild(m_node, std::uint32_t(fromIndex), std::uint32_t(toIndex));
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::PopNode (void) {
+    if (m_nodeStack.empty()) {
+        m_node = MappedDataMap::s_noNode;
+        return *this;
+    }
+
+    m_node = m_nodeStack.back();
+    m_nodeStack.pop_back();
+    return *this;
+}
+
+//=========================================================================
+void MappedDataMapMutator::PushNode (std::uint32_t node) {
+    m_nodeStack.push_back(m_node);
+    m_node = node;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::ReadBool (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ReadBool() called, but the Mutator is invalid.");
+    #endif
+
+    return GetNode().m_value != 0;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::ReadBoolSafe (bool * outBool) const {
+    if (!IsValid() || GetNode().GetType() != DataNode::Type::Bool)
+        return false;
+    *outBool = GetNode().m_value != 0;
+    return true;
+}
+
+//=========================================================================
+float MappedDataMapMutator::ReadFloat (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ReadFloat() called, but the Mutator is invalid.");
+    #endif
+
+    float value;
+    std::memcpy(&value, &GetNode().m_value, sizeof(value));
+    return value;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::ReadFloatSafe (float * outFloat) const {
+    if (!IsValid() || GetNode().GetType() != DataNode::Type::Float)
+        return false;
+    std::memcpy(outFloat, &GetNode().m_value, sizeof(*outFloat));
+    return true;
+}
+
+//=========================================================================
+int MappedDataMapMutator::ReadInt (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ReadInt() called, but the Mutator is invalid.");
+    #endif
+
+    return int(GetNode().m_value);
+}
+
+//=========================================================================
+bool MappedDataMapMutator::ReadIntSafe (int * outInt) const {
+    if (!IsValid() || GetNode().GetType() != DataNode::Type::Int)
+        return false;
+    *outInt = int(GetNode().m_value);
+    return true;
+}
+
+//=========================================================================
+const char * MappedDataMapMutator::ReadName (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ReadName() called, but the Mutator is invalid.");
+    #endif
+
+    return m_map->GetString(GetNode().m_nameOffset);
+}
+
+//=========================================================================
+const char * MappedDataMapMutator::ReadString (void) const {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ReadString() called, but the Mutator is invalid.");
+        assert(
+            GetNode().GetType() == DataNode::Type::String &&
+                "MappedDataMapMutator::ReadString() called, but the node's type is not Type::String."
+        );
+    #endif
+
+    return m_map->GetString(GetNode().m_value);
+}
+
+//=========================================================================
+bool MappedDataMapMutator::ReadStringSafe (char * outString, int bufferSizeInElements) const {
+    if (!IsValid() || GetNode().GetType() != DataNode::Type::String || bufferSizeInElements < 1)
+        return false;
+
+    const char * source = m_map->GetString(GetNode().m_value);
+    int          length = 0;
+    while (length < bufferSizeInElements - 1 && source[length]) {
+        outString[length] = source[length];
+        ++length;
+    }
+    outString[length] = '\0';
+    return true;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::SetToArrayType (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::SetToArrayType() called, but the Mutator is invalid.");
+    #endif
+
+    if (GetNode().IsContainerType()) {
+        m_map->Touch();
+        GetNode().m_type = std::uint8_t(DataNode::Type::Array);
+    }
+    else {
+        m_map->ResetValue(m_node, DataNode::Type::Array);
+    }
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::SetToNullType (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::SetToNullType() called, but the Mutator is invalid.");
+    #endif
+
+    m_map->ResetValue(m_node, DataNode::Type::Null);
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::SetToObjectType (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::SetToObjectType() called, but the Mutator is invalid.");
+    #endif
+
+    if (GetNode().IsContainerType()) {
+        m_map->Touch();
+        GetNode().m_type = std::uint8_t(DataNode::Type::Object);
+    }
+    else {
+        m_map->ResetValue(m_node, DataNode::Type::Object);
+    }
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToChild (int index) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToChild(int index) called, but the Mutator is invalid.");
+        assert(index >= 0 && "MappedDataMapMutator::ToChild(int index) called with a negative index.");
+    #endif
+
+    // this is a mutator.  If there are not enough children, create them
+    while (GetNode().m_childCount <= std::uint32_t(index)) {
+        if (m_map->InsertChild(m_node, GetNode().m_childCount) == MappedDataMap::s_noNode) {
+            PushNode(MappedDataMap::s_noNode);
+            return *this;
+        }
+    }
+
+    PushNode(GetNode().m_childBegin + std::uint32_t(index));
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToChild (const char * name) {
+    return ToChild(DataKey::FromString(name));
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToChild (const DataKey & key) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToChild(const DataKey & key) called, but the Mutator is invalid.");
+    #endif
+
+    std::uint32_t child = m_map->FindChild(m_node, key);
+
+    // this is a mutator.  If there is no such child, create one
+    if (child == MappedDataMap::s_noNode) {
+        const std::uint32_t index = GetNode().m_childCount;
+        child = m_map->InsertChild(m_node, index);
+        if (child != MappedDataMap::s_noNode && !m_map->SetName(child, key.m_name, key.m_length)) {
+            m_map->DeleteChild(m_node, index);
+            child = MappedDataMap::s_noNode;
+        }
+    }
+
+    PushNode(child);
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToFirstChild (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToFirstChild() called, but the Mutator is invalid.");
+    #endif
+
+    // this is a mutator.  If there are no children, create one
+    if (GetNode().m_childCount == 0)
+        PushNode(m_map->InsertChild(m_node, 0));
+    else
+        PushNode(GetNode().m_childBegin);
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToLastChild (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToLastChild() called, but the Mutator is invalid.");
+    #endif
+
+    // this is a mutator.  If there are no children, create one
+    if (GetNode().m_childCount == 0)
+        PushNode(m_map->InsertChild(m_node, 0));
+    else
+        PushNode(GetNode().m_childBegin + GetNode().m_childCount - 1);
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToNextSibling (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToNextSibling() called, but the Mutator is invalid.");
+        assert(!m_nodeStack.empty() && "MappedDataMapMutator::ToNextSibling() called, but the Mutator is at the root.");
+    #endif
+
+    const std::uint32_t    parent     = m_nodeStack.back();
+    const OffsetDataNode & parentNode = m_map->GetNodes()[parent];
+    const std::uint32_t    index      = m_node - parentNode.m_childBegin + 1;
+
+    // this is a mutator.  If there is no next sibling, create one
+    if (index < parentNode.m_childCount)
+        m_node = parentNode.m_childBegin + index;
+    else
+        m_node = m_map->InsertChild(parent, index);
+    return *this;
+}
+
+//=========================================================================
+MappedDataMapMutator & MappedDataMapMutator::ToPreviousSibling (void) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::ToPreviousSibling() called, but the Mutator is invalid.");
+        assert(!m_nodeStack.empty() && "MappedDataMapMutator::ToPreviousSibling() called, but the Mutator is at the root.");
+    #endif
+
+    const std::uint32_t    parent     = m_nodeStack.back();
+    const OffsetDataNode & parentNode = m_map->GetNodes()[parent];
+    const std::uint32_t    index      = m_node - parentNode.m_childBegin;
+
+    // this is a mutator.  If there is no previous sibling, create one
+    if (index > 0)
+        m_node = parentNode.m_childBegin + index - 1;
+    else
+        m_node = m_map->InsertChild(parent, 0);
+    return *this;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (bool boolValue) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::Write(bool) called, but the Mutator is invalid.");
+    #endif
+
+    m_map->ResetValue(m_node, DataNode::Type::Bool);
+    GetNode().m_value = boolValue ? 1 : 0;
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (const char * name, bool boolValue) {
+    const bool named = WriteName(name);
+    return Write(boolValue) && named;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (int intValue) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::Write(int) called, but the Mutator is invalid.");
+    #endif
+
+    m_map->ResetValue(m_node, DataNode::Type::Int);
+    GetNode().m_value = std::uint32_t(intValue);
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (const char * name, int intValue) {
+    const bool named = WriteName(name);
+    return Write(intValue) && named;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (float floatValue) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::Write(float) called, but the Mutator is invalid.");
+    #endif
+
+    m_map->ResetValue(m_node, DataNode::Type::Float);
+    std::memcpy(&GetNode().m_value, &floatValue, sizeof(floatValue));
+    return true;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (const char * name, float floatValue) {
+    const bool named = WriteName(name);
+    return Write(floatValue) && named;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (const char * stringValue) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::Write(const char *) called, but the Mutator is invalid.");
+    #endif
+
+    return m_map->SetString(m_node, stringValue, std::strlen(stringValue));
+}
+
+//=========================================================================
+bool MappedDataMapMutator::Write (const char * name, const char * stringValue) {
+    const bool named = WriteName(name);
+    return Write(stringValue) && named;
+}
+
+//=========================================================================
+bool MappedDataMapMutator::WriteName (const char * name) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::WriteName() called, but the Mutator is invalid.");
+    #endif
+
+    return m_map->SetName(m_node, name, std::strlen(name));
+}
+
+//=========================================================================
+bool MappedDataMapMutator::WriteNode (const DataNode & value) {
+    #if MAPPEDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "MappedDataMapMutator::WriteNode() called, but the Mutator is invalid.");
+    #endif
+
+    return m_map->SetSubtree(m_node, value);
+}
+
+} // namespace CSaruDataMap
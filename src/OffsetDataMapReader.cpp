@@ -0,0 +1,331 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <cassert>
+#include <cstring>
+
+#include "exported/DataKey.hpp"
+#include "exported/OffsetDataMapReader.hpp"
+
+#define OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS 1
+#define OFFSETDATAMAPREADER_EXTRA_SAFETY_CHECKS 1
+
+namespace CSaruDataMap {
+
+//=========================================================================
+OffsetDataMapReader::OffsetDataMapReader (
+    const OffsetDataNode * nodes,
+    std::uint32_t          nodeCount,
+    const char *           strings,
+    std::uint32_t          stringBytes,
+    std::uint32_t          root
+)
+    : m_nodes(nodes)
+    , m_nodeCount(nodeCount)
+    , m_strings(strings)
+    , m_stringBytes(stringBytes)
+    , m_node(root < nodeCount ? root : s_noNode)
+    , m_sequence(nullptr)
+    , m_startSequence(0)
+{}
+
+//=========================================================================
+OffsetDataMapReader::OffsetDataMapReader (const void * image)
+    : m_nodes(OffsetDataMapImage::GetNodes(image))
+    , m_nodeCount(OffsetDataMapImage::GetHeader(image)->m_nodeCount)
+    , m_strings(OffsetDataMapImage::GetStrings(image))
+    , m_stringBytes(OffsetDataMapImage::GetHeader(image)->m_stringBytes)
+    , m_node(m_nodeCount ? 0 : s_noNode)
+    , m_sequence(nullptr)
+    , m_startSequence(0)
+{}
+
+//=========================================================================
+OffsetDataMapReader::OffsetDataMapReader (
+    const OffsetDataNode *             nodes,
+    std::uint32_t                      nodeCount,
+    const char *                       strings,
+    std::uint32_t                      stringBytes,
+    const std::atomic<std::uint64_t> * sequence,
+    std::uint64_t                      startSequence
+)
+    : m_nodes(nodes)
+    , m_nodeCount(nodeCount)
+    , m_strings(strings)
+    , m_stringBytes(stringBytes)
+    , m_node(nodeCount ? 0 : s_noNode)
+    , m_sequence(sequence)
+    , m_startSequence(startSequence)
+{}
+
+//=========================================================================
+std::uint32_t OffsetDataMapReader::FindChild (const DataKey & key) const {
+    const OffsetDataNode & parent = m_nodes[m_node];
+    if (parent.m_childBegin >= m_nodeCount)
+        return s_noNode;
+
+    // a torn image may claim more children than there are nodes.
+    std::uint32_t end = parent.m_childBegin + parent.m_childCount;
+    if (end > m_nodeCount || end < parent.m_childBegin)
+        end = m_nodeCount;
+
+    for (std::uint32_t i = parent.m_childBegin;  i < end;  ++i) {
+        if (m_nodes[i].m_nameHash == key.m_hash && key.MatchesName(GetString(m_nodes[i].m_nameOffset)))
+            return i;
+    }
+    return s_noNode;
+}
+
+//=========================================================================
+const char * OffsetDataMapReader::GetString (std::uint32_t offset) const {
+    return offset < m_stringBytes ? m_strings + offset : "";
+}
+
+//=========================================================================
+bool OffsetDataMapReader::IsStale (void) const {
+    if (m_sequence == nullptr)
+        return false;
+
+    // the writer only starts overwriting the buffer this Reader was given
+    //  two publishes after the one it was made during (or after).
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_sequence->load(std::memory_order_relaxed) >= (m_startSequence & ~std::uint64_t(1)) + 3;
+}
+
+//=========================================================================
+void OffsetDataMapReader::PushNode (std::uint32_t node) {
+    m_nodeStack.push_back(m_node);
+    m_node = node < m_nodeCount ? node : s_noNode;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::PopNode (void) {
+    if (m_nodeStack.empty()) {
+        m_node = s_noNode;
+        return *this;
+    }
+
+    m_node = m_nodeStack.back();
+    m_nodeStack.pop_back();
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToFirstChild (void) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToFirstChild() called, but the Reader is invalid.");
+    #endif
+
+    const OffsetDataNode & node = m_nodes[m_node];
+    PushNode(node.m_childCount ? node.m_childBegin : s_noNode);
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToLastChild (void) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToLastChild() called, but the Reader is invalid.");
+    #endif
+
+    const OffsetDataNode & node = m_nodes[m_node];
+    PushNode(node.m_childCount ? node.m_childBegin + node.m_childCount - 1 : s_noNode);
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToChild (int index) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToChild(int) called, but the Reader is invalid.");
+    #endif
+
+    const OffsetDataNode & node = m_nodes[m_node];
+    const bool inRange = index >= 0 && std::uint32_t(index) < node.m_childCount;
+    PushNode(inRange ? node.m_childBegin + std::uint32_t(index) : s_noNode);
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToChild (const char * name) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToChild(const char *) called, but the Reader is invalid.");
+        assert(name && "OffsetDataMapReader::ToChild(const char *) called, but name == nullptr.");
+    #endif
+
+    PushNode(FindChild(DataKey::FromString(name)));
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToChild (const DataKey & key) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToChild(const DataKey &) called, but the Reader is invalid.");
+    #endif
+
+    PushNode(FindChild(key));
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToNextSibling (void) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToNextSibling() called, but the Reader is invalid.");
+    #endif
+
+    // if on root node, invalidate
+    if (m_nodeStack.empty()) {
+        m_node = s_noNode;
+        return *this;
+    }
+
+    const OffsetDataNode & parent = m_nodes[m_nodeStack.back()];
+    const std::uint32_t    next   = m_node + 1;
+    m_node = next - parent.m_childBegin < parent.m_childCount && next < m_nodeCount ? next : s_noNode;
+    return *this;
+}
+
+//=========================================================================
+OffsetDataMapReader & OffsetDataMapReader::ToPreviousSibling (void) {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ToPreviousSibling() called, but the Reader is invalid.");
+    #endif
+
+    // if on root node, invalidate
+    if (m_nodeStack.empty()) {
+        m_node = s_noNode;
+        return *this;
+    }
+
+    const OffsetDataNode & parent = m_nodes[m_nodeStack.back()];
+    m_node = m_node > parent.m_childBegin ? m_node - 1 : s_noNode;
+    return *this;
+}
+
+//=========================================================================
+const char * OffsetDataMapReader::ReadName (void) const {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ReadName() called, but the Reader is invalid.");
+    #endif
+
+    return GetString(m_nodes[m_node].m_nameOffset);
+}
+
+//=========================================================================
+bool OffsetDataMapReader::ReadBool (void) const {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ReadBool() called, but the Reader is invalid.");
+    #endif
+    #if OFFSETDATAMAPREADER_EXTRA_SAFETY_CHECKS
+        assert(
+            m_nodes[m_node].GetType() == DataNode::Type::Bool &&
+                "OffsetDataMapReader::ReadBool() called, but the node's type is not Type::Bool."
+        );
+    #endif
+
+    return m_nodes[m_node].m_value != 0;
+}
+
+//=========================================================================
+int OffsetDataMapReader::ReadInt (void) const {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ReadInt() called, but the Reader is invalid.");
+    #endif
+    #if OFFSETDATAMAPREADER_EXTRA_SAFETY_CHECKS
+        assert(
+            m_nodes[m_node].GetType() == DataNode::Type::Int &&
+                "OffsetDataMapReader::ReadInt() called, but the node's type is not Type::Int."
+        );
+    #endif
+
+    return int(m_nodes[m_node].m_value);
+}
+
+//=========================================================================
+float OffsetDataMapReader::ReadFloat (void) const {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ReadFloat() called, but the Reader is invalid.");
+    #endif
+    #if OFFSETDATAMAPREADER_EXTRA_SAFETY_CHECKS
+        assert(
+            m_nodes[m_node].GetType() == DataNode::Type::Float &&
+                "OffsetDataMapReader::ReadFloat() called, but the node's type is not Type::Float."
+        );
+    #endif
+
+    float value;
+    std::memcpy(&value, &m_nodes[m_node].m_value, sizeof(value));
+    return value;
+}
+
+//=========================================================================
+const char * OffsetDataMapReader::ReadString (void) const {
+    #if OFFSETDATAMAPREADER_BASIC_SAFETY_CHECKS
+        assert(IsValid() && "OffsetDataMapReader::ReadString() called, but the Reader is invalid.");
+    #endif
+    #if OFFSETDATAMAPREADER_EXTRA_SAFETY_CHECKS
+        assert(
+            m_nodes[m_node].GetType() == DataNode::Type::String &&
+                "OffsetDataMapReader::ReadString() called, but the node's type is not Type::String."
+        );
+    #endif
+
+    return GetString(m_nodes[m_node].m_value);
+}
+
+//=========================================================================
+bool OffsetDataMapReader::ReadBoolSafe (bool * outBool) const {
+    if (!IsValid() || m_nodes[m_node].GetType() != DataNode::Type::Bool)
+        return false;
+    *outBool = m_nodes[m_node].m_value != 0;
+    return true;
+}
+
+//=========================================================================
+bool OffsetDataMapReader::ReadIntSafe (int * outInt) const {
+    if (!IsValid() || m_nodes[m_node].GetType() != DataNode::Type::Int)
+        return false;
+    *outInt = int(m_nodes[m_node].m_value);
+    return true;
+}
+
+//=========================================================================
+bool OffsetDataMapReader::ReadFloatSafe (float * outFloat) const {
+    if (!IsValid() || m_nodes[m_node].GetType() != DataNode::Type::Float)
+        return false;
+    std::memcpy(outFloat, &m_nodes[m_node].m_value, sizeof(*outFloat));
+    return true;
+}
+
+//=========================================================================
+bool OffsetDataMapReader::ReadStringSafe (char * outString, int bufferSizeInElements) const {
+    if (!IsValid() || m_nodes[m_node].GetType() != DataNode::Type::String || bufferSizeInElements < 1)
+        return false;
+
+    const char * source = GetString(m_nodes[m_node].m_value);
+    int          length = 0;
+    while (length < bufferSizeInElements - 1 && source[length]) {
+        outString[length] = source[length];
+        ++length;
+    }
+    outString[length] = '\0';
+    return true;
+}
+
+} // namespace CSaruDataMap
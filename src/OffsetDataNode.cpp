@@ -0,0 +1,200 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "exported/OffsetDataNode.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+// adds str to the table, unless it's already there.
+static std::uint32_t InternString (
+    const char *                                    str,
+    std::vector<char> *                             strings,
+    std::unordered_map<std::string, std::uint32_t> * offsets
+) {
+    std::unordered_map<std::string, std::uint32_t>::iterator it = offsets->find(str);
+    if (it != offsets->end())
+        return it->second;
+
+    const std::uint32_t offset = std::uint32_t(strings->size());
+    strings->insert(strings->end(), str, str + std::strlen(str) + 1);
+    offsets->emplace(str, offset);
+    return offset;
+}
+
+//=========================================================================
+void OffsetDataMapImage::Build (const DataNode & root, std::vector<std::uint8_t> * out) {
+    std::vector<const DataNode *>                  sources(1, &root);
+    std::vector<OffsetDataNode>                    nodes;
+    std::vector<char>                              strings(1, '\0');
+    std::unordered_map<std::string, std::uint32_t> offsets;
+    offsets.emplace("", 0);
+
+    // breadth-first, so each node's children land next to each other.
+    for (std::size_t i = 0;  i < sources.size();  ++i) {
+        const DataNode & source = *sources[i];
+        OffsetDataNode   node;
+        std::memset(&node, 0, sizeof(node));
+
+        node.m_nameOffset = InternString(source.GetName(), &strings, &offsets);
+        node.m_nameHash   = source.m_nameHash;
+        node.m_type       = std::uint8_t(source.GetType());
+
+        switch (source.GetType()) {
+            case DataNode::Type::Bool:   node.m_value = source.GetBool() ? 1 : 0;              break;
+            case DataNode::Type::Int:    node.m_value = std::uint32_t(source.GetInt());        break;
+            case DataNode::Type::Float: {
+                const float value = source.GetFloat();
+                std::memcpy(&node.m_value, &value, sizeof(node.m_value));
+            } break;
+            case DataNode::Type::String: node.m_value = InternString(source.GetString(), &strings, &offsets); break;
+
+            case DataNode::Type::Object:
+            case DataNode::Type::Array: {
+                node.m_childBegin = std::uint32_t(sources.size());
+                node.m_childCount = std::uint32_t(source.GetChildCount());
+                for (int c = 0;  c < source.GetChildCount();  ++c)
+                    sources.push_back(source.GetChildFast(c));
+            } break;
+
+            default: break;
+        }
+
+        nodes.push_back(node);
+    }
+
+    OffsetDataMapHeader header;
+    header.m_magic       = s_magic;
+    header.m_nodeCount   = std::uint32_t(nodes.size());
+    header.m_stringBytes = std::uint32_t(strings.size());
+    header.m_imageSize   = std::uint32_t(sizeof(header) + nodes.size() * sizeof(OffsetDataNode) + strings.size());
+
+    out->resize(header.m_imageSize);
+    std::uint8_t * dest = out->data();
+    std::memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    std::memcpy(dest, nodes.data(), nodes.size() * sizeof(OffsetDataNode));
+    dest += nodes.size() * sizeof(OffsetDataNode);
+    std::memcpy(dest, strings.data(), strings.size());
+}
+
+//=========================================================================
+void OffsetDataMapImage::ToDataNode (const OffsetDataNode * nodes, const char * strings, DataNode * outRoot, std::uint32_t root) {
+    struct Step {
+        std::uint32_t m_index;
+        DataNode *    m_out;
+    };
+
+    outRoot->DeleteAllChildren();
+    std::vector<Step> steps(1, Step{root, outRoot});
+    while (!steps.empty()) {
+        const Step step = steps.back();
+        steps.pop_back();
+
+        const OffsetDataNode & node = nodes[step.m_index];
+        DataNode *             out  = step.m_out;
+        out->SetName(strings + node.m_nameOffset);
+
+        switch (node.GetType()) {
+            case DataNode::Type::Bool:   out->SetBool(node.m_value != 0);               break;
+            case DataNode::Type::Int:    out->SetInt(int(node.m_value));                 break;
+            case DataNode::Type::Float: {
+                float value;
+                std::memcpy(&value, &node.m_value, sizeof(value));
+                out->SetFloat(value);
+            } break;
+            case DataNode::Type::String: out->SetString(strings + node.m_value);         break;
+
+            case DataNode::Type::Object:
+            case DataNode::Type::Array: {
+                out->SetType(node.GetType());
+                out->ReserveChildren(int(node.m_childCount));
+                for (std::uint32_t c = 0;  c < node.m_childCount;  ++c)
+                    out->AppendNewChild();
+                for (std::uint32_t c = 0;  c < node.m_childCount;  ++c)
+                    steps.push_back(Step{node.m_childBegin + c, out->GetChildFast(int(c))});
+            } break;
+
+            default: out->SetType(node.GetType()); break;
+        }
+    }
+}
+
+//=========================================================================
+bool OffsetDataMapImage::Validate (const void * image, std::size_t size) {
+    if (size < sizeof(OffsetDataMapHeader))
+        return false;
+
+    const OffsetDataMapHeader * header = GetHeader(image);
+    const std::uint64_t nodeBytes = std::uint64_t(header->m_nodeCount) * sizeof(OffsetDataNode);
+    if (
+        header->m_magic != s_magic ||
+        header->m_nodeCount == 0 ||
+        header->m_stringBytes == 0 ||
+        header->m_imageSize != size ||
+        sizeof(OffsetDataMapHeader) + nodeBytes + header->m_stringBytes != size
+    ) {
+        return false;
+    }
+
+    const OffsetDataNode * nodes   = GetNodes(image);
+    const char *           strings = GetStrings(image);
+    if (strings[header->m_stringBytes - 1] != '\0')
+        return false;
+
+    // children are laid out breadth-first, as Build() does: each parent's
+    //  run starts where the last one ended, so every node but the root has
+    //  exactly one parent, and there are no cycles.
+    std::uint64_t nextChild = 1;
+    for (std::uint32_t i = 0;  i < header->m_nodeCount;  ++i) {
+        const OffsetDataNode & node = nodes[i];
+        if (node.m_nameOffset >= header->m_stringBytes || node.m_type > std::uint8_t(DataNode::Type::String))
+            return false;
+
+        if (node.m_childCount) {
+            if (
+                !node.IsContainerType() ||
+                node.m_childBegin <= i ||
+                node.m_childBegin != nextChild ||
+                nextChild + node.m_childCount > header->m_nodeCount
+            ) {
+                return false;
+            }
+            nextChild += node.m_childCount;
+        }
+
+        // names and strings have to fit in a DataNode.
+        if (std::strlen(strings + node.m_nameOffset) >= DataNode::s_nameSize)
+            return false;
+        if (node.GetType() == DataNode::Type::String) {
+            if (node.m_value >= header->m_stringBytes || std::strlen(strings + node.m_value) >= DataNode::s_stringDataSize)
+                return false;
+        }
+    }
+
+    return nextChild == header->m_nodeCount;
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,135 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <cassert>
+
+#include "exported/ShardedDataMap.hpp"
+
+namespace CSaruDataMap {
+
+//=========================================================================
+ShardedDataMap::LockedMutator::LockedMutator (std::mutex & mutex, DataNode * shardRoot)
+    : m_lock(mutex)
+    , m_mutator(shardRoot)
+{}
+
+//=========================================================================
+ShardedDataMap::LockedReader::LockedReader (std::mutex & mutex, const DataNode * shardRoot)
+    : m_lock(mutex)
+    , m_reader(shardRoot)
+{}
+
+//=========================================================================
+ShardedDataMap::WholeMapLock::WholeMapLock (const ShardedDataMap & map)
+    : m_map(&map)
+{
+    m_locks.reserve(map.m_shardCount);
+    for (unsigned s = 0;  s < map.m_shardCount;  ++s)
+        m_locks.push_back(std::unique_lock<std::mutex>(map.m_shards[s].m_mutex));
+}
+
+//=========================================================================
+int ShardedDataMap::WholeMapLock::GetShardCount (void) const {
+    return int(m_map->m_shardCount);
+}
+
+//=========================================================================
+DataMapReader ShardedDataMap::WholeMapLock::GetShardReader (int shardIndex) const {
+    #ifdef _DEBUG
+        assert(shardIndex >= 0 && unsigned(shardIndex) < m_map->m_shardCount &&
+         "ShardedDataMap::WholeMapLock::GetShardReader() called with an invalid shard index.");
+    #endif
+    return DataMapReader(&m_map->m_shards[shardIndex].m_root);
+}
+
+//=========================================================================
+int ShardedDataMap::WholeMapLock::GetChildCount (void) const {
+    int childCount = 0;
+    for (unsigned s = 0;  s < m_map->m_shardCount;  ++s)
+        childCount += m_map->m_shards[s].m_root.GetChildCount();
+    return childCount;
+}
+
+//=========================================================================
+void ShardedDataMap::WholeMapLock::CopyTo (DataNode * dest) const {
+    dest->SetType(DataNode::Type::Null);
+    dest->SetType(DataNode::Type::Object);
+    dest->m_children.reserve(GetChildCount());
+
+    ForEachChild([dest](const DataNode & child) {
+        *dest->AppendNewChild() = child;
+    });
+}
+
+//=========================================================================
+ShardedDataMap::ShardedDataMap (unsigned shardCount)
+    : m_shards(nullptr)
+    , m_shardCount(shardCount ? shardCount : 1)
+{
+    m_shards = new Shard[m_shardCount];
+    for (unsigned s = 0;  s < m_shardCount;  ++s) {
+        m_shards[s].m_root.SetName("UNNAMED");
+        m_shards[s].m_root.SetType(DataNode::Type::Object);
+    }
+}
+
+//=========================================================================
+ShardedDataMap::~ShardedDataMap () {
+    delete[] m_shards;
+}
+
+//=========================================================================
+unsigned ShardedDataMap::GetShardIndex (const char * key) const {
+    return DataKey::HashString(key) % m_shardCount;
+}
+
+//=========================================================================
+ShardedDataMap::LockedMutator ShardedDataMap::LockForWrite (const char * key) {
+    LockedMutator locked = LockShardForWrite(GetShardIndex(key));
+    locked->ToChild(key);
+    return locked;
+}
+
+//=========================================================================
+ShardedDataMap::LockedReader ShardedDataMap::LockForRead (const char * key) const {
+    LockedReader locked = LockShardForRead(GetShardIndex(key));
+    locked->ToChild(key);
+    return locked;
+}
+
+//=========================================================================
+ShardedDataMap::LockedMutator ShardedDataMap::LockShardForWrite (unsigned shardIndex) {
+    #ifdef _DEBUG
+        assert(shardIndex < m_shardCount && "ShardedDataMap::LockShardForWrite() called with an invalid shard index.");
+    #endif
+    Shard & shard = m_shards[shardIndex];
+    return LockedMutator(shard.m_mutex, &shard.m_root);
+}
+
+//=========================================================================
+ShardedDataMap::LockedReader ShardedDataMap::LockShardForRead (unsigned shardIndex) const {
+    #ifdef _DEBUG
+        assert(shardIndex < m_shardCount && "ShardedDataMap::LockShardForRead() called with an invalid shard index.");
+    #endif
+    Shard & shard = m_shards[shardIndex];
+    return LockedReader(shard.m_mutex, &shard.m_root);
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,253 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "exported/SharedDataMap.hpp"
+
+#define SHAREDDATAMAP_BASIC_SAFETY_CHECKS 1
+
+namespace CSaruDataMap {
+
+//=========================================================================
+static std::size_t RoundUpToAlign (std::size_t size, std::size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+//=========================================================================
+SharedDataMap::SharedDataMap (void)
+    : m_segment(nullptr)
+    , m_segmentSize(0)
+    , m_isWriter(false)
+{}
+
+//=========================================================================
+SharedDataMap::~SharedDataMap () {
+    Detach();
+}
+
+//=========================================================================
+bool SharedDataMap::Attach (const char * name) {
+    Detach();
+
+    #ifdef _WIN32
+        (void)name;
+        return false;
+    #else
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || std::size_t(info.st_size) < s_bufferAlign || !Map(fd, std::size_t(info.st_size), false)) {
+            close(fd);
+            return false;
+        }
+        close(fd);
+
+        // the segment has to be exactly what Create() would have made.
+        const Control * control = GetControl();
+        const std::size_t bufferSpace = RoundUpToAlign(control->m_bufferSize, s_bufferAlign);
+        if (
+            control->m_magic != s_magic ||
+            control->m_bufferSize <= sizeof(OffsetDataMapHeader) ||
+            m_segmentSize != s_bufferAlign + 2 * bufferSpace ||
+            !control->m_sequence.is_lock_free()
+        ) {
+            Detach();
+            return false;
+        }
+
+        m_name = name;
+        return true;
+    #endif
+}
+
+//=========================================================================
+bool SharedDataMap::Create (const char * name, std::size_t bufferSize) {
+    Detach();
+
+    #if SHAREDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(sizeof(Control) <= s_bufferAlign && "SharedDataMap::Control no longer fits before the buffers.");
+    #endif
+
+    #ifdef _WIN32
+        (void)name;
+        (void)bufferSize;
+        return false;
+    #else
+        if (bufferSize <= sizeof(OffsetDataMapHeader) || bufferSize > 0xFFFFFFFFu)
+            return false;
+
+        // never truncate a segment others may still have mapped; they'd
+        //  fault on its pages.  Unlink it, and start a fresh one.
+        shm_unlink(name);
+        const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            return false;
+
+        // new pages are zeroed, so the last byte of each buffer starts out
+        //  null (see Publish()).
+        const std::size_t size = s_bufferAlign + 2 * RoundUpToAlign(bufferSize, s_bufferAlign);
+        if (ftruncate(fd, off_t(size)) != 0 || !Map(fd, size, true)) {
+            close(fd);
+            shm_unlink(name);
+            return false;
+        }
+        close(fd);
+
+        Control * control = new (m_segment) Control;
+        if (!control->m_sequence.is_lock_free()) {
+            Detach();
+            shm_unlink(name);
+            return false;
+        }
+        control->m_bufferSize = std::uint32_t(bufferSize);
+        control->m_sequence.store(0, std::memory_order_relaxed);
+
+        DataNode empty;
+        empty.SetType(DataNode::Type::Object);
+        OffsetDataMapImage::Build(empty, &m_image);
+        std::memcpy(GetBuffer(0), m_image.data(), m_image.size());
+
+        // readers check the magic last.
+        std::atomic_thread_fence(std::memory_order_release);
+        control->m_magic = s_magic;
+
+        m_name     = name;
+        m_isWriter = true;
+        return true;
+    #endif
+}
+
+//=========================================================================
+void SharedDataMap::Detach (void) {
+    #ifndef _WIN32
+        if (m_segment)
+            munmap(m_segment, m_segmentSize);
+    #endif
+
+    m_segment     = nullptr;
+    m_segmentSize = 0;
+    m_isWriter    = false;
+    m_name.clear();
+}
+
+//=========================================================================
+std::uint8_t * SharedDataMap::GetBuffer (int index) const {
+    return m_segment + s_bufferAlign + index * RoundUpToAlign(GetControl()->m_bufferSize, s_bufferAlign);
+}
+
+//=========================================================================
+std::uint64_t SharedDataMap::GetVersion (void) const {
+    return m_segment ? GetControl()->m_sequence.load(std::memory_order_acquire) / 2 : 0;
+}
+
+//=========================================================================
+bool SharedDataMap::Map (int fd, std::size_t size, bool writable) {
+    #ifdef _WIN32
+        (void)fd;
+        (void)size;
+        (void)writable;
+        return false;
+    #else
+        void * segment = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (segment == MAP_FAILED)
+            return false;
+
+        m_segment     = static_cast<std::uint8_t *>(segment);
+        m_segmentSize = size;
+        return true;
+    #endif
+}
+
+//=========================================================================
+bool SharedDataMap::Publish (const DataNode & root) {
+    #if SHAREDDATAMAP_BASIC_SAFETY_CHECKS
+        assert(m_isWriter && "SharedDataMap::Publish() called, but this map didn't Create() the segment.");
+    #endif
+
+    // the last byte of a buffer is never written, so that any string a
+    //  reader starts on ends inside it, however torn the image.
+    Control * control = GetControl();
+    OffsetDataMapImage::Build(root, &m_image);
+    if (m_image.size() >= control->m_bufferSize)
+        return false;
+
+    const std::uint64_t sequence = control->m_sequence.load(std::memory_order_relaxed);
+    control->m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(GetBuffer(int((sequence / 2 + 1) % 2)), m_image.data(), m_image.size());
+
+    control->m_sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+//=========================================================================
+OffsetDataMapReader SharedDataMap::Read (void) const {
+    if (m_segment == nullptr)
+        return OffsetDataMapReader(nullptr, 0, nullptr, 0);
+
+    const Control *      control  = GetControl();
+    const std::uint64_t  sequence = control->m_sequence.load(std::memory_order_acquire);
+    const std::uint8_t * buffer   = GetBuffer(int((sequence / 2) % 2));
+
+    // the header may be torn too; keep everything inside the buffer.
+    OffsetDataMapHeader header;
+    std::memcpy(&header, buffer, sizeof(header));
+
+    const std::uint32_t maxNodes  = std::uint32_t((control->m_bufferSize - sizeof(header)) / sizeof(OffsetDataNode));
+    const std::uint32_t nodeCount = header.m_nodeCount < maxNodes ? header.m_nodeCount : maxNodes;
+    const std::size_t   stringsAt = sizeof(header) + std::size_t(nodeCount) * sizeof(OffsetDataNode);
+    const std::size_t   maxBytes  = control->m_bufferSize - stringsAt;
+    const std::uint32_t stringBytes = header.m_stringBytes < maxBytes ? header.m_stringBytes : std::uint32_t(maxBytes);
+
+    return OffsetDataMapReader(
+        reinterpret_cast<const OffsetDataNode *>(buffer + sizeof(header)),
+        nodeCount,
+        reinterpret_cast<const char *>(buffer + stringsAt),
+        stringBytes,
+        &control->m_sequence,
+        sequence
+    );
+}
+
+//=========================================================================
+bool SharedDataMap::Remove (const char * name) {
+    #ifdef _WIN32
+        (void)name;
+        return false;
+    #else
+        return shm_unlink(name) == 0;
+    #endif
+}
+
+} // namespace CSaruDataMap
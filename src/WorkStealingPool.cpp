@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "exported/WorkStealingPool.hpp"
+
+namespace CSaruDataMap {
+
+// which pool the current thread works for (if any), and its index there.
+static thread_local const WorkStealingPool * s_currentPool        = nullptr;
+static thread_local int                      s_currentWorkerIndex = -1;
+
+//=========================================================================
+WorkStealingPool::WorkStealingPool (unsigned threadCount)
+    : m_queuedCount(0)
+    , m_nextWorker(0)
+    , m_stopping(false)
+    , m_sleeperCount(0)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    m_workers.reserve(threadCount);
+    for (unsigned w = 0;  w < threadCount;  ++w)
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker));
+
+    m_threads.reserve(threadCount);
+    for (unsigned w = 0;  w < threadCount;  ++w)
+        m_threads.push_back(std::thread(&WorkStealingPool::WorkerMain, this, int(w)));
+}
+
+//=========================================================================
+WorkStealingPool::~WorkStealingPool () {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping.store(true);
+    }
+    m_wake.notify_all();
+
+    for (std::thread & thread : m_threads)
+        thread.join();
+}
+
+//=========================================================================
+int WorkStealingPool::GetCurrentWorkerIndex (void) const {
+    return s_currentPool == this ? s_currentWorkerIndex : -1;
+}
+
+//=========================================================================
+void WorkStealingPool::Submit (Task task) {
+    int target = GetCurrentWorkerIndex();
+    if (target < 0)
+        target = int(m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+
+    {
+        Worker & worker = *m_workers[target];
+        std::lock_guard<std::mutex> lock(worker.m_mutex);
+        worker.m_tasks.push_back(std::move(task));
+    }
+    m_queuedCount.fetch_add(1);
+
+    // a worker counts itself a sleeper before it checks m_queuedCount, and
+    //  this checks the sleepers after raising it, so one of the two sees the
+    //  other.  With nobody asleep, there's no one to wake.
+    if (m_sleeperCount.load() == 0)
+        return;
+
+    // take the sleep lock so a worker between its check and its wait can't
+    //  miss this.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+//=========================================================================
+bool WorkStealingPool::PopTask (int self, Task * outTask) {
+    const int workerCount = int(m_workers.size());
+
+    // newest of our own first; it's the one most likely still in cache.
+    if (self >= 0) {
+        Worker & worker = *m_workers[self];
+        std::lock_guard<std::mutex> lock(worker.m_mutex);
+        if (!worker.m_tasks.empty()) {
+            *outTask = std::move(worker.m_tasks.back());
+            worker.m_tasks.pop_back();
+            return true;
+        }
+    }
+
+    // then steal the oldest of someone else's, which tends to be the biggest.
+    const int start = self >= 0 ? self + 1 : 0;
+    for (int i = 0;  i < workerCount;  ++i) {
+        const int victim = (start + i) % workerCount;
+        if (victim == self)
+            continue;
+
+        Worker & worker = *m_workers[victim];
+        std::lock_guard<std::mutex> lock(worker.m_mutex);
+        if (!worker.m_tasks.empty()) {
+            *outTask = std::move(worker.m_tasks.front());
+            worker.m_tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//=========================================================================
+bool WorkStealingPool::TryRunOne (void) {
+    if (m_queuedCount.load() == 0)
+        return false;
+
+    Task task;
+    if (!PopTask(GetCurrentWorkerIndex(), &task))
+        return false;
+
+    m_queuedCount.fetch_sub(1);
+    task();
+    return true;
+}
+
+//=========================================================================
+void WorkStealingPool::WorkerMain (int index) {
+    s_currentPool        = this;
+    s_currentWorkerIndex = index;
+
+    for (;;) {
+        if (TryRunOne())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        if (m_stopping.load() && m_queuedCount.load() == 0)
+            break;
+
+        // Submit() only notifies while someone is counted here.
+        m_sleeperCount.fetch_add(1);
+        m_wake.wait(lock, [this] () {
+            return m_stopping.load() || m_queuedCount.load() > 0;
+        });
+        m_sleeperCount.fetch_sub(1);
+    }
+
+    s_currentPool        = nullptr;
+    s_currentWorkerIndex = -1;
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,980 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DataKey.hpp"
+#include "DataMapMutatorListener.hpp"
+#include "DataMapPolicy.hpp"
+#include "DataNode.hpp"
+#include "DataPath.hpp"
+
+namespace CSaruDataMap {
+
+// Reader and Mutator with their safety checks chosen by a policy (see
+//  DataMapPolicy.hpp), so checked and unchecked access can live side by side:
+//
+//      BasicDataMapReader<UncheckedPolicy>      hot(&root);     // no branches
+//      BasicDataMapReader<ErrorReturningPolicy> tool(&root);    // all checks
+//
+// DataMapReader and DataMapMutator are these with AssertingPolicy; there is
+//  no other implementation.
+//
+// A cursor keeps the nodes above it on a stack, back up to the node it was
+//  made at, which is as far up as PopNode() goes.  It also remembers that
+//  node's structure version and the child index taken at each level, so that
+//  a change made elsewhere (through another cursor, or to the nodes directly)
+//  is noticed: every move and change first Revalidate()s, walking back down
+//  by index if the structure changed since this cursor's last use.
+//
+// A Reader move which finds no node (no such child, no next sibling, ...)
+//  leaves the cursor invalid; PopNode() backs out of that.
+//
+// Mutator navigation creates whatever is missing, and every change is
+//  announced to its DataMapMutatorListener, if it has one, so transactions,
+//  journals, and snapshots see it.  A check that fails (see the policy) skips
+//  the change before the listener hears of it.
+template <typename Derived, typename Node, typename Policy>
+class BasicDataMapCursor : public Policy {
+protected:
+    // Data
+    Node *              m_node;
+    std::vector<Node *> m_nodeStack;        // does *not* contain m_node
+
+    // the node this cursor started at, its structure version as of this
+    //  cursor's last use, and the child index taken for each m_nodeStack
+    //  level below it (-1 where a move found no node).
+    Node *              m_base;
+    std::uint32_t       m_seatedVersion;
+    std::vector<int>    m_indexPath;
+
+    // Helpers
+    inline Derived & Self (void) { return static_cast<Derived &>(*this); }
+
+    inline Derived & PushNode (Node * node) {
+        m_nodeStack.push_back(m_node);
+        m_indexPath.push_back(node ? node->GetIndexInParent() : -1);
+        m_node = node;
+        return Self();
+    }
+
+    inline bool CheckNode (const char * message) const {
+        return this->Check(m_node != nullptr, message);
+    }
+
+    inline bool CheckType (DataNode::Type type, const char * message) const {
+        return this->Check(m_node != nullptr && m_node->GetType() == type, message);
+    }
+
+public:
+    // Methods
+    explicit BasicDataMapCursor (Node * node)
+        : m_node(node)
+        , m_base(node)
+        , m_seatedVersion(node ? node->GetStructureVersion() : 0)
+    {}
+
+    inline const Node * GetCurrentNode (void) const    { return m_node; }
+    inline Node * GetCurrentNode (void)                { return m_node; }
+
+    inline bool IsValid (void) const                   { return m_node != nullptr; }
+
+    // RETURNS: true if children have been added, removed, or replaced anywhere
+    //  under this cursor's starting node since it was last used, by anything
+    //  other than this cursor itself.  Its node pointers may have gone bad.
+    //  O(1).
+    inline bool IsStale (void) const {
+        return m_base && m_base->GetStructureVersion() != m_seatedVersion;
+    }
+
+    // walks back down from the starting node along the child indices this
+    //  cursor took to get where it is.  It lands on whichever nodes are at
+    //  those indices now; no nodes are created.
+    // RETURNS: IsValid().
+    bool Reseat (void) {
+        // popped off the top; there is nowhere to go back to.
+        if (m_base == nullptr || (m_node == nullptr && m_nodeStack.empty()))
+            return false;
+
+        Node * node = m_base;
+        const int depth = int(m_indexPath.size());
+        for (int i = 0;  i < depth;  ++i) {
+            m_nodeStack[i] = node;
+            node = node ? node->GetChildSafe(m_indexPath[i]) : nullptr;
+        }
+        m_node = node;
+        m_seatedVersion = m_base->GetStructureVersion();
+        return m_node != nullptr;
+    }
+
+    // Reseat()s only if IsStale().  Navigation and mutation methods do this on
+    //  their own; call it before reading if the map may have changed since.
+    // RETURNS: IsValid().
+    inline bool Revalidate (void)                      { return IsStale() ? Reseat() : IsValid(); }
+
+    ///////
+    // navigation (begin)
+
+    // return to the parent node, or out of a failed move.
+    // NOTE: If this is used on the starting node, the cursor becomes
+    //  invalidated.
+    inline Derived & PopNode (void) {
+        Revalidate();
+        if (m_nodeStack.empty()) {
+            m_node = nullptr;
+        }
+        else {
+            m_node = m_nodeStack.back();
+            m_nodeStack.pop_back();
+            m_indexPath.pop_back();
+        }
+        return Self();
+    }
+
+    // synonym for PopNode().
+    inline Derived & ToParent (void)                   { return Self().PopNode(); }
+
+    // navigation (end)
+    ///////
+    // reading (begin)
+
+    inline const char * ReadName (void) const {
+        if (!CheckNode("ReadName() called, but m_node == nullptr."))
+            return nullptr;
+        return m_node->GetName();
+    }
+
+    inline bool ReadBool (void) const {
+        if (!CheckType(DataNode::Type::Bool, "ReadBool() called, but m_node isn't a Bool."))
+            return false;
+        return m_node->GetBool();
+    }
+
+    inline int ReadInt (void) const {
+        if (!CheckType(DataNode::Type::Int, "ReadInt() called, but m_node isn't an Int."))
+            return 0;
+        return m_node->GetInt();
+    }
+
+    inline float ReadFloat (void) const {
+        if (!CheckType(DataNode::Type::Float, "ReadFloat() called, but m_node isn't a Float."))
+            return 0.0f;
+        return m_node->GetFloat();
+    }
+
+    inline const char * ReadString (void) const {
+        if (!CheckType(DataNode::Type::String, "ReadString() called, but m_node isn't a String."))
+            return nullptr;
+        return m_node->GetString();
+    }
+
+    // always checked, whatever the policy, and never count as a failed check.
+    // RETURNS: true on success (and the out parameter is written to).
+    //          false otherwise, and the out parameter is not written to.
+    inline bool ReadBoolSafe (bool * outBool) const    { return m_node && m_node->QueryBool(outBool); }
+    inline bool ReadIntSafe (int * outInt) const       { return m_node && m_node->QueryInt(outInt); }
+    inline bool ReadFloatSafe (float * outFloat) const { return m_node && m_node->QueryFloat(outFloat); }
+    inline bool ReadStringSafe (char * outString, int bufferSizeInElements) const {
+        return m_node && m_node->QueryString(outString, bufferSizeInElements);
+    }
+
+    // each of these reads, then moves on to the next sibling.
+    inline bool ReadBoolWalk (void) {
+        const bool result = ReadBool();
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline int ReadIntWalk (void) {
+        const int result = ReadInt();
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline float ReadFloatWalk (void) {
+        const float result = ReadFloat();
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline const char * ReadStringWalk (void) {
+        const char * result = ReadString();
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline bool ReadBoolWalkSafe (bool * outBool) {
+        const bool result = ReadBoolSafe(outBool);
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline bool ReadIntWalkSafe (int * outInt) {
+        const bool result = ReadIntSafe(outInt);
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline bool ReadFloatWalkSafe (float * outFloat) {
+        const bool result = ReadFloatSafe(outFloat);
+        Self().ToNextSibling();
+        return result;
+    }
+
+    inline bool ReadStringWalkSafe (char * outString, int bufferSizeInElements) {
+        const bool result = ReadStringSafe(outString, bufferSizeInElements);
+        Self().ToNextSibling();
+        return result;
+    }
+
+    // reading (end)
+    ///////
+};
+
+template <typename Policy>
+class BasicDataMapReader : public BasicDataMapCursor<BasicDataMapReader<Policy>, const DataNode, Policy> {
+private:
+    typedef BasicDataMapCursor<BasicDataMapReader<Policy>, const DataNode, Policy> Base;
+
+    // Helpers
+    // moves offset places along the current node's siblings.
+    inline BasicDataMapReader & ToSibling (int offset, const char * message) {
+        this->Revalidate();
+        if (!this->CheckNode(message))
+            return *this;
+
+        // the starting node has no siblings as far as this Reader knows.
+        if (this->m_nodeStack.empty()) {
+            this->m_node = nullptr;
+            return *this;
+        }
+        const int index = this->m_node->GetIndexInParent() + offset;
+        this->m_node = this->m_nodeStack.back()->GetChildSafe(index);
+        this->m_indexPath.back() = index;
+        return *this;
+    }
+
+public:
+    // Methods
+    explicit BasicDataMapReader (const DataNode * node) : Base(node) {}
+
+    // RETURNS: -1 if invalidated, 0 if at the starting node, 1 if at one of
+    //  its children, and so on.
+    inline int GetCurrentDepth (void) const {
+        return int(this->m_nodeStack.size()) - 1 + (this->m_node == nullptr ? 0 : 1);
+    }
+
+    ///////
+    // navigation (begin)
+
+    // if there are no children, the current node will become null.  You must
+    //  PopNode to back out of this state.
+    inline BasicDataMapReader & ToFirstChild (void) {
+        this->Revalidate();
+        if (!this->CheckNode("ToFirstChild() called, but m_node == nullptr."))
+            return *this;
+        return this->PushNode(this->m_node->GetChildSafe(0));
+    }
+
+    // if there are no children, the current node will become null.  You must
+    //  PopNode to back out of this state.
+    inline BasicDataMapReader & ToLastChild (void) {
+        this->Revalidate();
+        if (!this->CheckNode("ToLastChild() called, but m_node == nullptr."))
+            return *this;
+        return this->PushNode(this->m_node->GetChildSafe(this->m_node->GetChildCount() - 1));
+    }
+
+    // if there is no child at the given index, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    inline BasicDataMapReader & ToChild (int index) {
+        this->Revalidate();
+        if (!this->CheckNode("ToChild(int index) called, but m_node == nullptr."))
+            return *this;
+        if (!this->Check(index >= 0, "ToChild(int index) called with a negative index."))
+            return *this;
+        return this->PushNode(this->m_node->GetChildSafe(index));
+    }
+
+    // if no child with such a name exists, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    inline BasicDataMapReader & ToChild (const char * name) {
+        this->Revalidate();
+        if (!this->CheckNode("ToChild(const char * name) called, but m_node == nullptr."))
+            return *this;
+        return this->PushNode(this->m_node->GetChildByName(name));
+    }
+
+    // same as above, but matches on the key's precomputed hash first.
+    inline BasicDataMapReader & ToChild (const DataKey & key) {
+        this->Revalidate();
+        if (!this->CheckNode("ToChild(const DataKey & key) called, but m_node == nullptr."))
+            return *this;
+        return this->PushNode(this->m_node->GetChildByName(key));
+    }
+
+    // follows every step of path from the current node, using the path's
+    //  cached child indices when they are still good.  Each step is one level;
+    //  PopNode once per step to come back.
+    // if some step doesn't exist, the current node will become null one level
+    //  below the deepest node that was found.  An invalid path goes null one
+    //  level below the current node.  You must PopNode to back out of this
+    //  state.
+    inline BasicDataMapReader & ToPath (const DataPath & path) {
+        this->Revalidate();
+        if (!this->CheckNode("ToPath() called, but m_node == nullptr."))
+            return *this;
+
+        const DataNode * target = path.Resolve(this->m_node);
+        for (int index : path.GetResolvedIndices())
+            this->PushNode(this->m_node->GetChildFast(index));
+        if (target == nullptr)
+            this->PushNode(nullptr);
+        return *this;
+    }
+
+    // same as PopNode(), then ToChild(GetIndexInParent() + 1), but without
+    //  touching the node stack.
+    // NOTE: If this is used on the starting node, the Reader becomes
+    //  invalidated.
+    inline BasicDataMapReader & ToNextSibling (void) {
+        return ToSibling(1, "ToNextSibling() called, but m_node == nullptr.");
+    }
+
+    // same as PopNode(), then ToChild(GetIndexInParent() - 1), but without
+    //  touching the node stack.
+    // NOTE: If this is used on the starting node, the Reader becomes
+    //  invalidated.
+    inline BasicDataMapReader & ToPreviousSibling (void) {
+        return ToSibling(-1, "ToPreviousSibling() called, but m_node == nullptr.");
+    }
+
+    // navigation (end)
+    ///////
+
+    BasicDataMapReader (void) = delete;
+};
+
+template <typename Policy>
+class BasicDataMapMutator : public BasicDataMapCursor<BasicDataMapMutator<Policy>, DataNode, Policy> {
+private:
+    typedef BasicDataMapCursor<BasicDataMapMutator<Policy>, DataNode, Policy> Base;
+
+    // Data
+    // told about every change this Mutator makes, if set.
+    DataMapMutatorListener * m_listener;
+
+    // Helpers
+    // brings this Mutator up to date before a change.
+    // RETURNS: true if it was, so that its own change can't have moved the
+    //  nodes on its stack.
+    inline bool BeginChange (void) {
+        this->Revalidate();
+        return !this->IsStale();
+    }
+
+    // a change this Mutator makes itself never moves the nodes on its own
+    //  stack, so if it was current going in, it still is.
+    inline void SyncAfterOwnChange (bool wasCurrent) {
+        if (wasCurrent && this->m_base)
+            this->m_seatedVersion = this->m_base->GetStructureVersion();
+        if (m_listener)
+            m_listener->AfterChange();
+    }
+
+    // the starting node must stay a container, so only nodes below it can
+    //  hold values.
+    inline bool CheckValueNode (const char * message) const {
+        return this->Check(this->m_node != nullptr && !this->m_nodeStack.empty(), message);
+    }
+
+    inline bool CheckSiblingMove (const char * message) const {
+        return this->CheckNode(message) &&
+            this->Check(!this->m_nodeStack.empty(), "Sibling move called, but m_node is the starting node.  Starting nodes are not allowed to have siblings.");
+    }
+
+    inline void BeforeNodeChange (bool keepChildren) {
+        if (m_listener)
+            m_listener->BeforeNodeChange(this->m_node, keepChildren);
+    }
+
+    inline DataNode * AppendChild (DataNode * parent) {
+        if (m_listener)
+            m_listener->BeforeInsert(parent, parent->GetChildCount());
+        return parent->AppendNewChild();
+    }
+
+public:
+    // Methods
+    explicit BasicDataMapMutator (DataNode * node) : Base(node), m_listener(nullptr) {}
+
+    // RETURNS: 0 if invalidated, 1 if at the starting node, 2 if at one of
+    //  its children, and so on.
+    inline int GetCurrentDepth (void) const {
+        return int(this->m_nodeStack.size()) + (this->m_node == nullptr ? 0 : 1);
+    }
+
+    // listener is told about every change made through this Mutator (and its
+    //  copies) before it happens.  nullptr to stop.
+    inline void SetListener (DataMapMutatorListener * listener) { m_listener = listener; }
+    inline DataMapMutatorListener * GetListener (void) const    { return m_listener; }
+
+    ///////
+    // navigation (begin)
+
+    // goes down from one node to one of its children.  Using this function to
+    //  go from the current node to one of its non-children is undefined.  This
+    //  class makes no attempt at saving you from this error; for performance
+    //  reasons.
+    // WARNING: You shouldn't need to use this function!
+    using Base::PushNode;
+
+    // return to the parent node.
+    // NOTE: If this is used on the starting node, the Mutator becomes
+    //  invalidated.
+    inline BasicDataMapMutator & PopNode (void) {
+        this->Revalidate();
+        if (!this->Check(!this->m_nodeStack.empty() || this->m_node == nullptr, "PopNode() called, but this Mutator was already at its starting node."))
+            return *this;
+        return Base::PopNode();
+    }
+
+    // NOTE: Advanced use only!
+    inline DataNode * GetParentNode (void) {
+        return this->m_nodeStack.empty() ? nullptr : this->m_nodeStack.back();
+    }
+
+    // if there are no children, one will be created.
+    inline BasicDataMapMutator & ToFirstChild (void) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("ToFirstChild() called, but m_node == nullptr."))
+            return *this;
+        DataNode * child = this->m_node->GetChildSafe(0);
+        this->PushNode(child ? child : AppendChild(this->m_node));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // if there are no children, one will be created.
+    inline BasicDataMapMutator & ToLastChild (void) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("ToLastChild() called, but m_node == nullptr."))
+            return *this;
+        DataNode * child = this->m_node->GetChildSafe(this->m_node->GetChildCount() - 1);
+        this->PushNode(child ? child : AppendChild(this->m_node));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // if there is no child at the given index, null children will be created
+    //  until a child at the given index can be pointed at.
+    // NOTE: If no child at the given index exists, this changes the structure
+    //  under this node, so other cursors on it will Revalidate() on their
+    //  next use.
+    inline BasicDataMapMutator & ToChild (int index) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("ToChild(int index) called, but m_node == nullptr."))
+            return *this;
+        if (!this->Check(index >= 0, "ToChild(int index) called with a negative index."))
+            return *this;
+        while (this->m_node->GetChildCount() <= index)
+            AppendChild(this->m_node);
+        this->PushNode(this->m_node->GetChildFast(index));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // if no child with such a name exists, a new null _last_ child will be
+    //  added with the given name.
+    // NOTE: If no child of the given name exists, this changes the structure
+    //  under this node, so other cursors on it will Revalidate() on their
+    //  next use.
+    inline BasicDataMapMutator & ToChild (const char * name) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("ToChild(const char * name) called, but m_node == nullptr."))
+            return *this;
+        DataNode * child = this->m_node->GetChildByName(name);
+        this->PushNode(child ? child : AppendChild(this->m_node)->SetName(name));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // same as above, but matches on the key's precomputed hash first.
+    inline BasicDataMapMutator & ToChild (const DataKey & key) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("ToChild(const DataKey & key) called, but m_node == nullptr."))
+            return *this;
+        DataNode * child = this->m_node->GetChildByName(key);
+        this->PushNode(child ? child : AppendChild(this->m_node)->SetNameSecure(key.m_name, int(key.m_length)));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // follows every step of path from the current node, using the path's
+    //  cached child indices when they are still good.  Each step is one level;
+    //  PopNode once per step to come back.
+    // if some step doesn't exist, it will be created as ToChild() would.  An
+    //  invalid path makes the current node null, one level down; you must
+    //  PopNode to back out of this state.
+    inline BasicDataMapMutator & ToPath (const DataPath & path) {
+        this->Revalidate();
+        if (!this->CheckNode("ToPath() called, but m_node == nullptr."))
+            return *this;
+
+        // there's nothing to create from a path that didn't compile
+        if (!path.IsValid())
+            return this->PushNode(nullptr);
+
+        // fast path: the whole path exists already
+        if (path.Resolve(this->m_node) != nullptr) {
+            for (int index : path.GetResolvedIndices())
+                this->PushNode(this->m_node->GetChildFast(index));
+            return *this;
+        }
+
+        const int stepCount = path.GetStepCount();
+        for (int i = 0;  i < stepCount;  ++i) {
+            const DataPath::Step & step = path.GetStep(i);
+            if (step.m_index < 0)
+                ToChild(step.m_name);
+            else
+                ToChild(step.m_index);
+        }
+        return *this;
+    }
+
+    // same as PopNode(), then ToChild(GetIndexInParent() + 1), but without
+    //  touching the node stack.  If there is no next sibling, one will be
+    //  created.
+    // NOTE: If this is used on the starting node, the Mutator becomes
+    //  invalidated.
+    inline BasicDataMapMutator & ToNextSibling (void) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckSiblingMove("ToNextSibling() called, but m_node == nullptr."))
+            return *this;
+        if (this->m_nodeStack.empty()) {
+            this->m_node = nullptr;
+            return *this;
+        }
+        DataNode * parent  = this->m_nodeStack.back();
+        DataNode * sibling = parent->GetChildSafe(this->m_node->GetIndexInParent() + 1);
+        this->m_node = sibling ? sibling : AppendChild(parent);
+        this->m_indexPath.back() = this->m_node->GetIndexInParent();
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // same as PopNode(), then ToChild(GetIndexInParent() - 1), but without
+    //  touching the node stack.  If there is no previous sibling, one will be
+    //  created as the first child.
+    // NOTE: If this is used on the starting node, the Mutator becomes
+    //  invalidated.
+    inline BasicDataMapMutator & ToPreviousSibling (void) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckSiblingMove("ToPreviousSibling() called, but m_node == nullptr."))
+            return *this;
+        if (this->m_nodeStack.empty()) {
+            this->m_node = nullptr;
+            return *this;
+        }
+        DataNode * parent  = this->m_nodeStack.back();
+        DataNode * sibling = parent->GetChildSafe(this->m_node->GetIndexInParent() - 1);
+        if (sibling == nullptr) {
+            if (m_listener)
+                m_listener->BeforeInsert(parent, 0);
+            sibling = parent->InsertNewChild(0);
+        }
+        this->m_node = sibling;
+        this->m_indexPath.back() = this->m_node->GetIndexInParent();
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // calls ToNextSibling() count times, creating siblings as needed.
+    inline void Walk (int count) {
+        for (int i = 0;  i < count;  ++i)
+            ToNextSibling();
+    }
+
+    inline bool IsFirstChild (void) {
+        // if no parent, is first child
+        if (this->m_nodeStack.size() <= 1)
+            return true;
+        return this->m_node->GetIndexInParent() == 0;
+    }
+    // synonym for IsFirstChild().
+    inline bool IsFirstSibling (void)                  { return IsFirstChild(); }
+
+    // navigation (end)
+    ///////
+    // writing (begin)
+
+    // containers keep their children; anything else loses them.
+    inline BasicDataMapMutator & SetType (DataNode::Type type) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("SetType() called, but m_node == nullptr."))
+            return *this;
+        BeforeNodeChange(type == DataNode::Type::Object || type == DataNode::Type::Array);
+        this->m_node->SetType(type);
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // most common type for children.  Same as array, but children are named.
+    inline BasicDataMapMutator & SetToObjectType (void)  { return SetType(DataNode::Type::Object); }
+
+    // same as object, but children are unnamed.
+    inline BasicDataMapMutator & SetToArrayType (void)   { return SetType(DataNode::Type::Array); }
+
+    // if children of the current node exist, they will be destroyed.  The
+    //  value is left for you to write.
+    inline BasicDataMapMutator & SetToBooleanType (void) {
+        this->Revalidate();
+        if (!CheckValueNode("SetToBooleanType() called, but m_node is null or the starting node.  Starting nodes must be of the Object or Array type."))
+            return *this;
+        return SetType(DataNode::Type::Bool);
+    }
+
+    // if children of the current node exist, they will be destroyed.
+    inline BasicDataMapMutator & SetToNullType (void) {
+        this->Revalidate();
+        if (!CheckValueNode("SetToNullType() called, but m_node is null or the starting node.  Starting nodes must be of the Object or Array type."))
+            return *this;
+        return SetType(DataNode::Type::Null);
+    }
+
+    // the new child is appended; the current node stays current.  If the
+    //  current node wasn't of a sort that could have children, it will be
+    //  changed to such (and lose any data it previously held).
+    // name [in]: can be NULL.
+    inline BasicDataMapMutator & CreateChild (const char * name = nullptr) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("CreateChild() called, but m_node == nullptr."))
+            return *this;
+        DataNode * child = AppendChild(this->m_node);
+        if (name != nullptr)
+            child->SetName(name);
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    inline BasicDataMapMutator & CreateChildSafe (const char * name, std::size_t nameLen) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("CreateChildSafe() called, but m_node == nullptr."))
+            return *this;
+        AppendChild(this->m_node)->SetNameSecure(name, int(nameLen));
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    // name [in]: can be NULL.
+    inline BasicDataMapMutator & CreateAndGotoChild (const char * name = nullptr) {
+        if (!CreateChild(name).IsValid())
+            return *this;
+        return this->PushNode(this->m_node->GetChildFast(this->m_node->GetChildCount() - 1));
+    }
+
+    inline BasicDataMapMutator & CreateAndGotoChildSafe (const char * name, std::size_t nameLen) {
+        if (!CreateChildSafe(name, nameLen).IsValid())
+            return *this;
+        return this->PushNode(this->m_node->GetChildFast(this->m_node->GetChildCount() - 1));
+    }
+
+    inline void WriteName (const char * name) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("WriteName() called, but m_node == nullptr."))
+            return;
+        BeforeNodeChange(true);
+        this->m_node->SetName(name);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // sizeInElements should not include the NULL terminator.  If name is too
+    //  large, as much of it as possible will be copied, and the internal copy
+    //  will be NULL-terminated.
+    inline void WriteNameSecure (const char * name, int sizeInElements) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("WriteNameSecure() called, but m_node == nullptr."))
+            return;
+        BeforeNodeChange(true);
+        this->m_node->SetNameSecure(name, sizeInElements);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // values can't be written to the starting node, which must stay a
+    //  container.
+    inline void Write (bool boolValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(bool) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetBool(boolValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (int intValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(int) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetInt(intValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (float floatValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(float) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetFloat(floatValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (const char * stringValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(const char *) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetString(stringValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // these also name the current node.
+    inline void Write (const char * name, bool boolValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(const char *, bool) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetName(name);
+        this->m_node->SetBool(boolValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (const char * name, int intValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(const char *, int) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetName(name);
+        this->m_node->SetInt(intValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (const char * name, float floatValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(const char *, float) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetName(name);
+        this->m_node->SetFloat(floatValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void Write (const char * name, const char * stringValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("Write(const char *, const char *) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetName(name);
+        this->m_node->SetString(stringValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // sizeInElements should not include the NULL terminator.  Too-long names
+    //  and strings are cut short.
+    inline void WriteSafe (const char * name, int nameSizeInElements, bool boolValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("WriteSafe(const char *, int, bool) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetNameSecure(name, nameSizeInElements);
+        this->m_node->SetBool(boolValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void WriteSafe (const char * name, int nameSizeInElements, int intValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("WriteSafe(const char *, int, int) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetNameSecure(name, nameSizeInElements);
+        this->m_node->SetInt(intValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void WriteSafe (const char * name, int nameSizeInElements, float floatValue) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("WriteSafe(const char *, int, float) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetNameSecure(name, nameSizeInElements);
+        this->m_node->SetFloat(floatValue);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void WriteSafe (const char * stringValue, int valueSizeInElements) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("WriteSafe(const char *, int) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetStringSecure(stringValue, valueSizeInElements);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    inline void WriteSafe (const char * name, int nameSizeInElements, const char * stringValue, int valueSizeInElements) {
+        const bool wasCurrent = BeginChange();
+        if (!CheckValueNode("WriteSafe(const char *, int, const char *, int) called, but m_node is null or the starting node."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetNameSecure(name, nameSizeInElements);
+        this->m_node->SetStringSecure(stringValue, valueSizeInElements);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // each of these writes, then moves on to the next sibling (creating it if
+    //  need be).
+    inline void WriteWalk (bool boolValue)                           { Write(boolValue);         ToNextSibling(); }
+    inline void WriteWalk (const char * name, bool boolValue)        { Write(name, boolValue);   ToNextSibling(); }
+    inline void WriteWalk (int intValue)                             { Write(intValue);          ToNextSibling(); }
+    inline void WriteWalk (const char * name, int intValue)          { Write(name, intValue);    ToNextSibling(); }
+    inline void WriteWalk (float floatValue)                         { Write(floatValue);        ToNextSibling(); }
+    inline void WriteWalk (const char * name, float floatValue)      { Write(name, floatValue);  ToNextSibling(); }
+    inline void WriteWalk (const char * stringValue)                 { Write(stringValue);       ToNextSibling(); }
+    inline void WriteWalk (const char * name, const char * stringValue) { Write(name, stringValue); ToNextSibling(); }
+
+    inline void WriteWalkSafe (const char * name, int nameSizeInElements, bool boolValue) {
+        WriteSafe(name, nameSizeInElements, boolValue);
+        ToNextSibling();
+    }
+
+    inline void WriteWalkSafe (const char * name, int nameSizeInElements, int intValue) {
+        WriteSafe(name, nameSizeInElements, intValue);
+        ToNextSibling();
+    }
+
+    inline void WriteWalkSafe (const char * name, int nameSizeInElements, float floatValue) {
+        WriteSafe(name, nameSizeInElements, floatValue);
+        ToNextSibling();
+    }
+
+    inline void WriteWalkSafe (const char * name, int nameSizeInElements, const char * stringValue, int valueSizeInElements) {
+        WriteSafe(name, nameSizeInElements, stringValue, valueSizeInElements);
+        ToNextSibling();
+    }
+
+    inline void WriteWalkSafeBooleanValue (const char * name, int nameSizeInElements, bool value) { WriteWalkSafe(name, nameSizeInElements, value); }
+    inline void WriteWalkSafeIntegerValue (const char * name, int nameSizeInElements, int value)  { WriteWalkSafe(name, nameSizeInElements, value); }
+
+    inline void WriteWalkSafeNullValue (const char * name, int nameSizeInElements) {
+        WriteNameSecure(name, nameSizeInElements);
+        SetToNullType();
+        ToNextSibling();
+    }
+
+    // deletes this node's last count children, or all of them if it has
+    //  fewer.
+    inline void DeleteLastChildren (int count) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("DeleteLastChildren() called, but m_node == nullptr."))
+            return;
+        for (int i = 0;  i < count && this->m_node->GetChildCount();  ++i) {
+            if (m_listener)
+                m_listener->BeforeDelete(this->m_node, this->m_node->GetChildCount() - 1);
+            this->m_node->DeleteLastChild();
+        }
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // inserts a new Null child at index, shifting later children over.  Stays
+    //  on the current node.
+    inline BasicDataMapMutator & InsertChild (int index) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("InsertChild() called, but m_node == nullptr."))
+            return *this;
+        if (!this->Check(index >= 0 && index <= this->m_node->GetChildCount(), "InsertChild() called with an invalid index."))
+            return *this;
+        if (m_listener)
+            m_listener->BeforeInsert(this->m_node, index);
+        if (!this->m_node->IsContainerType())
+            this->m_node->SetType(DataNode::Type::Object);
+        this->m_node->InsertNewChild(index)->SetType(DataNode::Type::Null);
+        SyncAfterOwnChange(wasCurrent);
+        return *this;
+    }
+
+    inline void DeleteChild (int index) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("DeleteChild() called, but m_node == nullptr."))
+            return;
+        if (!this->Check(index >= 0 && index < this->m_node->GetChildCount(), "DeleteChild() called with an invalid index."))
+            return;
+        if (m_listener)
+            m_listener->BeforeDelete(this->m_node, index);
+        this->m_node->DeleteChild(index);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // see DataNode::MoveChild().
+    inline void MoveChild (int fromIndex, int toIndex) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("MoveChild() called, but m_node == nullptr."))
+            return;
+        const int childCount = this->m_node->GetChildCount();
+        if (!this->Check(fromIndex >= 0 && fromIndex < childCount && toIndex >= 0 && toIndex < childCount, "MoveChild() called with an invalid index."))
+            return;
+        if (m_listener)
+            m_listener->BeforeMove(this->m_node, fromIndex, toIndex);
+        this->m_node->MoveChild(fromIndex, toIndex);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // replaces the current node's type, value, and children with copies of
+    //  value's.  The current node keeps its own name.
+    inline void WriteNode (const DataNode & value) {
+        const bool wasCurrent = BeginChange();
+        if (!this->CheckNode("WriteNode() called, but m_node == nullptr."))
+            return;
+        BeforeNodeChange(false);
+        this->m_node->SetContents(value);
+        SyncAfterOwnChange(wasCurrent);
+    }
+
+    // writing (end)
+    ///////
+
+    BasicDataMapMutator (void) = delete;
+};
+
+typedef BasicDataMapReader<UncheckedPolicy>       UncheckedDataMapReader;
+typedef BasicDataMapReader<AssertingPolicy>       AssertingDataMapReader;
+typedef BasicDataMapReader<ThrowingPolicy>        ThrowingDataMapReader;
+typedef BasicDataMapReader<ErrorReturningPolicy>  ErrorReturningDataMapReader;
+
+typedef BasicDataMapMutator<UncheckedPolicy>      UncheckedDataMapMutator;
+typedef BasicDataMapMutator<AssertingPolicy>      AssertingDataMapMutator;
+typedef BasicDataMapMutator<ThrowingPolicy>       ThrowingDataMapMutator;
+typedef BasicDataMapMutator<ErrorReturningPolicy> ErrorReturningDataMapMutator;
+
+} // namespace CSaruDataMap
@@ -0,0 +1,133 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+#include "DataMapMutator.hpp"
+#include "DataMapReader.hpp"
+
+namespace CSaruDataMap {
+
+// Read-copy-update wrapper around a DataNode tree.  Any number of threads may
+//  read the currently published version through ReadHandles without taking a
+//  lock.  A single writer builds the next version on a private copy through a
+//  DataMapMutator, then publishes it atomically.  Old versions are reclaimed
+//  once no ReadHandle can still be pinning them (epoch-based reclamation).
+//
+// Writer-side calls (BeginWrite, GetWriteMutator, Publish, AbandonWrite,
+//  Reclaim) must only ever be made from one thread at a time.
+class ConcurrentDataMap {
+public:
+    // Type and Constants
+    static const unsigned s_maxReaderSlots = 128;
+
+    // Pins the version of the map that was published when it was created.
+    //  Readers obtained from a ReadHandle are valid for the handle's lifetime,
+    //  no matter how many versions are published in the meantime.
+    class ReadHandle {
+    private:
+        // Data
+        const ConcurrentDataMap * m_map;
+        unsigned                  m_slot;
+        const DataNode *          m_root;
+
+    public:
+        // Methods
+        explicit ReadHandle (const ConcurrentDataMap & map);
+        ReadHandle (ReadHandle && other);
+        ~ReadHandle ();
+
+        inline const DataNode * GetRoot (void) const { return m_root; }
+        DataMapReader GetReader (void) const;
+
+        // releases the pinned version early.  GetRoot() returns nullptr after.
+        void Release (void);
+
+        ReadHandle (void) = delete;
+        ReadHandle (const ReadHandle &) = delete;
+        ReadHandle & operator= (const ReadHandle &) = delete;
+    };
+
+private:
+    // Types
+    struct alignas(64) ReaderSlot {
+        // 0 if unused, otherwise the global epoch the reader pinned.
+        std::atomic<std::uint64_t> m_epoch;
+    };
+
+    struct RetiredVersion {
+        DataNode *    m_root;
+        std::uint64_t m_epoch;
+    };
+
+    // Helpers
+    unsigned AcquireSlot (void) const;
+    void ReleaseSlot (unsigned slot) const;
+
+    // Data
+    std::atomic<DataNode *>     m_published;
+    std::atomic<std::uint64_t>  m_globalEpoch;
+    mutable ReaderSlot          m_readerSlots[s_maxReaderSlots];
+
+    // writer-only state
+    DataNode *                  m_pending;
+    std::vector<RetiredVersion> m_retired;
+
+public:
+    // Methods
+    ConcurrentDataMap (void);
+    // NOTE: No ReadHandles may outlive the map.
+    ~ConcurrentDataMap ();
+
+    inline ReadHandle Read (void) const                { return ReadHandle(*this); }
+
+    // starts building a new version as a copy of the currently published one.
+    //  If a write was already in progress, its changes are kept.
+    // WARNING: potentially VERY SLOW.  Copies the entire published tree.
+    DataMapMutator BeginWrite (void);
+
+    // RETURNS: a Mutator at the root of the version being built, or an
+    //  invalid Mutator if BeginWrite() has not been called.
+    DataMapMutator GetWriteMutator (void);
+
+    inline bool IsWriting (void) const                 { return m_pending != nullptr; }
+
+    // atomically makes the version being built visible to new ReadHandles,
+    //  then reclaims any versions no longer pinned by a reader.
+    void Publish (void);
+
+    // throws away the version being built.
+    void AbandonWrite (void);
+
+    // frees retired versions which no reader can still be pinning.
+    // RETURNS: the number of versions still waiting on readers.
+    int Reclaim (void);
+
+    DISALLOW_COPY_AND_ASSIGN(ConcurrentDataMap)
+};
+
+} // namespace CSaruDataMap
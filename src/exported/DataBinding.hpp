@@ -0,0 +1,320 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+    #define CSARU_DATAMAP_HAS_OPTIONAL 1
+    #include <optional>
+#else
+    #define CSARU_DATAMAP_HAS_OPTIONAL 0
+#endif
+
+#include "DataKey.hpp"
+#include "DataNode.hpp"
+
+// Binds user structs to DataNodes.  A type lists its fields once, at global
+//  scope, and can then be read from and written to Object nodes:
+//
+//      struct Enemy {
+//          int                 hp = 10;
+//          std::string         name;
+//          std::vector<Weapon> weapons;    // Weapon has its own binding
+//      };
+//      CSARU_DATAMAP_BINDING(Enemy,
+//          CSARU_DATAMAP_FIELD(Enemy, hp),
+//          CSARU_DATAMAP_FIELD(Enemy, name),
+//          CSARU_DATAMAP_FIELD_NAMED(Enemy, weapons, "arms")
+//      )
+//
+//      ReadBound(node, &enemy);
+//      WriteBound(&node, enemy);
+//
+// The field list is unrolled at compile time, each field's name hash is
+//  worked out once, and reading makes a single pass over the node's children.
+//
+// Fields may be bool, int, float, std::string, other bound types, and
+//  std::vector or (C++17) std::optional of any of those.  A member missing
+//  from the map keeps whatever value it had, so member initializers double as
+//  defaults.
+//
+// NOTE: NAME must be a string literal short enough to fit in a DataNode's
+//  name; longer ones fail to compile rather than being cut short.
+#define CSARU_DATAMAP_FIELD_NAMED(TYPE, MEMBER, NAME) \
+    ::CSaruDataMap::MakeDataField(NAME, &TYPE::MEMBER)
+
+#define CSARU_DATAMAP_FIELD(TYPE, MEMBER) \
+    CSARU_DATAMAP_FIELD_NAMED(TYPE, MEMBER, #MEMBER)
+
+// NOTE: Must be used at global scope.
+#define CSARU_DATAMAP_BINDING(TYPE, ...) \
+    namespace CSaruDataMap { \
+        template <> \
+        struct DataBinding<TYPE> { \
+            typedef decltype(std::make_tuple(__VA_ARGS__)) FieldList; \
+            static const FieldList & Fields (void) { \
+                static const FieldList s_fields = std::make_tuple(__VA_ARGS__); \
+                return s_fields; \
+            } \
+        }; \
+    }
+
+namespace CSaruDataMap {
+
+// specialized by CSARU_DATAMAP_BINDING.
+template <typename T>
+struct DataBinding;
+
+template <typename T, typename M>
+struct DataField {
+    typedef M MemberType;
+
+    DataKey m_key;
+    M T::*  m_member;
+};
+
+template <typename T, typename M>
+inline DataField<T, M> MakeDataField (const DataKey & key, M T::* member) {
+    DataField<T, M> field = { key, member };
+    return field;
+}
+
+template <std::size_t N, typename T, typename M>
+inline DataField<T, M> MakeDataField (const char (&name)[N], M T::* member) {
+    static_assert(N <= DataNode::s_nameSize, "Field name is too long for a DataNode name.");
+    return MakeDataField(DataKey(name, N - 1), member);
+}
+
+// RETURNS: false if node isn't an Object, if a field which isn't optional is
+//  missing, or if any field's node has the wrong type.  Fields which could be
+//  read are written to out either way.
+template <typename T>
+bool ReadBound (const DataNode & node, T * out);
+
+// replaces node's type and any children it had with an Object holding value.
+template <typename T>
+void WriteBound (DataNode * node, const T & value);
+
+// How one field's value moves to and from its own node.  The primary template
+//  covers bound types.
+template <typename T>
+struct DataValueTraits {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const T &)                   { return true; }
+    static inline bool Read (const DataNode & node, T * out)   { return ReadBound(node, out); }
+    static inline void Write (DataNode * node, const T & value) { WriteBound(node, value); }
+};
+
+template <>
+struct DataValueTraits<bool> {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const bool &)                    { return true; }
+    static inline bool Read (const DataNode & node, bool * out)    { return node.QueryBool(out); }
+    static inline void Write (DataNode * node, const bool & value) { node->SetBool(value); }
+};
+
+template <>
+struct DataValueTraits<int> {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const int &)                    { return true; }
+    static inline bool Read (const DataNode & node, int * out)    { return node.QueryInt(out); }
+    static inline void Write (DataNode * node, const int & value) { node->SetInt(value); }
+};
+
+template <>
+struct DataValueTraits<float> {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const float &)                    { return true; }
+    static inline bool Read (const DataNode & node, float * out)    { return node.QueryFloat(out); }
+    static inline void Write (DataNode * node, const float & value) { node->SetFloat(value); }
+};
+
+template <>
+struct DataValueTraits<std::string> {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const std::string &) { return true; }
+    static inline bool Read (const DataNode & node, std::string * out) {
+        if (node.GetType() != DataNode::Type::String)
+            return false;
+        *out = node.GetString();
+        return true;
+    }
+    static inline void Write (DataNode * node, const std::string & value) {
+        node->SetStringSecure(value.c_str(), int(value.size()));
+    }
+};
+
+// any container node will do when reading; Arrays are written.
+template <typename E>
+struct DataValueTraits<std::vector<E>> {
+    static const bool s_optional = false;
+    static inline bool IsPresent (const std::vector<E> &) { return true; }
+    static inline bool Read (const DataNode & node, std::vector<E> * out) {
+        if (!node.IsContainerType())
+            return false;
+        const int childCount = node.GetChildCount();
+        out->clear();
+        out->reserve(childCount);
+        bool ok = true;
+        // through a local, since std::vector<bool> has no element to point at.
+        for (int c = 0;  c < childCount;  ++c) {
+            E element{};
+            ok = DataValueTraits<E>::Read(*node.GetChildFast(c), &element) && ok;
+            out->push_back(std::move(element));
+        }
+        return ok;
+    }
+    static inline void Write (DataNode * node, const std::vector<E> & value) {
+        node->DeleteAllChildren();
+        node->SetType(DataNode::Type::Array);
+        for (const E & element : value)
+            DataValueTraits<E>::Write(node->AppendNewChild(), element);
+    }
+};
+
+#if CSARU_DATAMAP_HAS_OPTIONAL
+// may be missing from the map.  Left empty if so, and not written if empty.
+template <typename E>
+struct DataValueTraits<std::optional<E>> {
+    static const bool s_optional = true;
+    static inline bool IsPresent (const std::optional<E> & value) { return value.has_value(); }
+    static inline bool Read (const DataNode & node, std::optional<E> * out) {
+        E value{};
+        if (!DataValueTraits<E>::Read(node, &value))
+            return false;
+        *out = std::move(value);
+        return true;
+    }
+    static inline void Write (DataNode * node, const std::optional<E> & value) {
+        DataValueTraits<E>::Write(node, *value);
+    }
+};
+#endif
+
+namespace DataBindingDetail {
+
+    // walks field I through N-1 of a binding's field list.
+    template <std::size_t I, std::size_t N>
+    struct FieldLoop {
+        // RETURNS: true if child belonged to some field not already seen.
+        template <typename T, typename Fields>
+        static inline bool MatchChild (
+            const Fields &   fields,
+            const DataNode & child,
+            T *              out,
+            std::uint64_t *  seen,
+            bool *           ok
+        ) {
+            typedef typename std::tuple_element<I, Fields>::type::MemberType M;
+
+            const auto &        field = std::get<I>(fields);
+            const std::uint64_t bit   = std::uint64_t(1) << I;
+            if (!(*seen & bit) && field.m_key.m_hash == child.GetNameHash() && field.m_key.MatchesName(child.GetName())) {
+                *seen |= bit;
+                if (!DataValueTraits<M>::Read(child, &(out->*field.m_member)))
+                    *ok = false;
+                return true;
+            }
+            return FieldLoop<I + 1, N>::MatchChild(fields, child, out, seen, ok);
+        }
+
+        template <typename Fields>
+        static inline bool RequiredSeen (std::uint64_t seen) {
+            typedef typename std::tuple_element<I, Fields>::type::MemberType M;
+
+            if (!DataValueTraits<M>::s_optional && !(seen & (std::uint64_t(1) << I)))
+                return false;
+            return FieldLoop<I + 1, N>::template RequiredSeen<Fields>(seen);
+        }
+
+        template <typename T, typename Fields>
+        static inline void Write (const Fields & fields, const T & value, DataNode * node) {
+            typedef typename std::tuple_element<I, Fields>::type::MemberType M;
+
+            const auto & field  = std::get<I>(fields);
+            const M &    member = value.*field.m_member;
+            if (DataValueTraits<M>::IsPresent(member)) {
+                DataNode * child = node->AppendNewChild();
+                child->SetNameSecure(field.m_key.m_name, int(field.m_key.m_length));
+                DataValueTraits<M>::Write(child, member);
+            }
+            FieldLoop<I + 1, N>::Write(fields, value, node);
+        }
+    };
+
+    template <std::size_t N>
+    struct FieldLoop<N, N> {
+        template <typename T, typename Fields>
+        static inline bool MatchChild (const Fields &, const DataNode &, T *, std::uint64_t *, bool *) { return false; }
+
+        template <typename Fields>
+        static inline bool RequiredSeen (std::uint64_t) { return true; }
+
+        template <typename T, typename Fields>
+        static inline void Write (const Fields &, const T &, DataNode *) {}
+    };
+
+} // namespace DataBindingDetail
+
+//=========================================================================
+template <typename T>
+bool ReadBound (const DataNode & node, T * out) {
+    typedef typename DataBinding<T>::FieldList Fields;
+    const std::size_t fieldCount = std::tuple_size<Fields>::value;
+    static_assert(fieldCount <= 64, "CSARU_DATAMAP_BINDING supports at most 64 fields per type.");
+    typedef DataBindingDetail::FieldLoop<0, fieldCount> Loop;
+
+    if (node.GetType() != DataNode::Type::Object)
+        return false;
+
+    const Fields &  fields     = DataBinding<T>::Fields();
+    const int       childCount = node.GetChildCount();
+    std::uint64_t   seen       = 0;
+    std::size_t     remaining  = fieldCount;
+    bool            ok         = true;
+
+    for (int c = 0;  c < childCount && remaining;  ++c) {
+        if (Loop::MatchChild(fields, *node.GetChildFast(c), out, &seen, &ok))
+            --remaining;
+    }
+
+    return ok && Loop::template RequiredSeen<Fields>(seen);
+}
+
+//=========================================================================
+template <typename T>
+void WriteBound (DataNode * node, const T & value) {
+    typedef typename DataBinding<T>::FieldList Fields;
+    const std::size_t fieldCount = std::tuple_size<Fields>::value;
+    static_assert(fieldCount <= 64, "CSARU_DATAMAP_BINDING supports at most 64 fields per type.");
+
+    node->DeleteAllChildren();
+    node->SetType(DataNode::Type::Object);
+    DataBindingDetail::FieldLoop<0, fieldCount>::Write(DataBinding<T>::Fields(), value, node);
+}
+
+} // namespace CSaruDataMap
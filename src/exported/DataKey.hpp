@@ -0,0 +1,86 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace CSaruDataMap {
+
+// A child name along with its length and hash, worked out ahead of time.
+//  Lookups by DataKey compare the hash against each DataNode's stored name
+//  hash, and only compare bytes on a match.
+//
+// For literal keys, use the _dk suffix (see DataKeyLiterals below).  Declare
+//  keys constexpr to be sure the hash is computed at compile time:
+//      static constexpr DataKey s_speedKey = "speed"_dk;
+class DataKey {
+public:
+    // Data
+    const char *  m_name;   // not necessarily null-terminated
+    std::uint32_t m_length;
+    std::uint32_t m_hash;
+
+public:
+    // Methods
+    constexpr DataKey (const char * name, std::size_t length)
+        : m_name(name)
+        , m_length(std::uint32_t(length))
+        , m_hash(HashName(name, length))
+    {}
+
+    // FNV-1a.  Must match HashString() exactly.
+    static constexpr std::uint32_t HashName (const char * name, std::size_t length, std::uint32_t hash = 2166136261u) {
+        return length == 0 ? hash : HashName(name + 1, length - 1, (hash ^ std::uint8_t(*name)) * 16777619u);
+    }
+
+    // run-time hash of a null-terminated name.
+    static inline std::uint32_t HashString (const char * name) {
+        std::uint32_t hash = 2166136261u;
+        for (const char * c = name;  *c;  ++c)
+            hash = (hash ^ std::uint8_t(*c)) * 16777619u;
+        return hash;
+    }
+
+    // for names which are only known at run time.
+    static inline DataKey FromString (const char * name) {
+        return DataKey(name, std::strlen(name));
+    }
+
+    // RETURNS: true if the null-terminated name is this key's name.  Does not
+    //  check the hash; callers are expected to have done that first.
+    inline bool MatchesName (const char * name) const {
+        return std::memcmp(name, m_name, m_length) == 0 && name[m_length] == '\0';
+    }
+
+    DataKey (void) = delete;
+};
+
+namespace DataKeyLiterals {
+
+    constexpr DataKey operator"" _dk (const char * name, std::size_t length) {
+        return DataKey(name, length);
+    }
+
+} // namespace DataKeyLiterals
+
+} // namespace CSaruDataMap
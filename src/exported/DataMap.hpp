@@ -20,6 +20,8 @@ freely, subject to the following restrictions:
 
 #pragma once
 
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
 #include "DataNode.hpp"
 #include "DataMapMutator.hpp"
 #include "DataMapReader.hpp"
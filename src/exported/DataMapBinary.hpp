@@ -0,0 +1,105 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Compact binary encoding of DataNode trees, as used by snapshot and journal
+//  files, and the local file handling they share.
+//
+// A node is encoded as its type (one byte), its name (varint length, then
+//  bytes), then by type:
+//      Bool            one byte
+//      Int, Float      four bytes, little-endian
+//      String          varint length, then bytes
+//      Object, Array   varint child count, then each child
+//
+// A snapshot file is s_snapshotMagic, then one encoded root.
+class DataMapBinary {
+public:
+    // Type and Constants
+    static const std::uint32_t s_snapshotMagic = 0x31444D53;  // "SMD1", little-endian
+    static const int           s_maxReadDepth  = 1024;
+
+    // Methods
+    static void AppendVarint (std::uint64_t value, std::vector<std::uint8_t> * out);
+    static void AppendUint32 (std::uint32_t value, std::vector<std::uint8_t> * out);
+
+    // RETURNS: bytes read, or 0 if data doesn't start with a whole varint.
+    static std::size_t ReadVarint (const std::uint8_t * data, std::size_t size, std::uint64_t * outValue);
+    static std::uint32_t ReadUint32 (const std::uint8_t * data);
+
+    // appends node's encoding to out.  Without children, containers are
+    //  written as if they had none.
+    static void AppendNode (const DataNode & node, std::vector<std::uint8_t> * out, bool withChildren = true);
+
+    // appends node's encoding up to its children, giving containers
+    //  childCount children, for the caller to append after.
+    static void AppendNodeHeader (const DataNode & node, int childCount, std::vector<std::uint8_t> * out);
+
+    // replaces outNode's name, type, value, and children with those encoded at
+    //  the start of data.
+    // RETURNS: bytes read, or 0 if data doesn't start with a whole, well-formed
+    //  node (outNode is then left partly written).  On 0, outTruncated (if
+    //  given) says whether data only ended too soon, so that more of it could
+    //  make the node whole, rather than holding something malformed.
+    static std::size_t ReadNode (const std::uint8_t * data, std::size_t size, DataNode * outNode, bool * outTruncated = nullptr);
+
+    ///////
+    // files (begin)
+
+    // writes data to a temp file beside path, syncs it, then renames it over
+    //  path, so that path holds either the old contents or the new, never a
+    //  mix.  Concurrent writers of one path each get their own temp file.
+    static bool WriteFileAtomically (const char * path, const std::uint8_t * data, std::size_t size);
+
+    // the same, for files written a piece at a time.  OpenTempFile() opens a
+    //  temp file named path + ".<pid>.<count>.tmp", and gives its name;
+    //  CommitTempFile() closes it and, if ok and everything written made it
+    //  to disk, renames it over path.  Otherwise the temp file is removed.
+    static std::FILE * OpenTempFile (const char * path, std::string * outTempPath);
+    static bool CommitTempFile (std::FILE * file, const char * tempPath, const char * path, bool ok);
+
+    // RETURNS: false if path can't be opened or read.
+    static bool ReadFile (const char * path, std::vector<std::uint8_t> * outData);
+
+    // flushes file and asks the OS to put it on disk before returning.
+    static bool SyncFile (std::FILE * file);
+
+    static bool SaveSnapshot (const char * path, const DataNode & root);
+    static bool LoadSnapshot (const char * path, DataNode * outRoot);
+
+    // files (end)
+    ///////
+
+    DataMapBinary (void) = delete;
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,82 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#pragma once
+
+#include <string>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Turns a DataMap into C++ source, for data which ships inside the program.
+//  The map becomes a constexpr OffsetDataNode array and string table, which
+//  the compiler places in read-only data: there's nothing to parse or build
+//  at startup, and processes running the program share the pages.
+//
+//      DataMapCodeGenerator::WriteFiles(root, "DefaultConfig", "Game", "DefaultConfig.hpp", "DefaultConfig.cpp");
+//
+//      // elsewhere, after compiling and linking DefaultConfig.cpp
+//      #include "DefaultConfig.hpp"
+//      OffsetDataMapReader reader = Game::GetDefaultConfigReader();
+//      int port = reader.ToChild("net").ToChild("port").ReadInt();
+//
+// For a given name, the generated header declares:
+//      OffsetDataMapReader    Get<name>Reader (void);     // at the root
+//      const OffsetDataNode * Get<name>Nodes (void);      // see OffsetDataMapImage::ToDataNode()
+//      const char *           Get<name>Strings (void);
+//
+// Names and namespaces must be C++ identifiers; namespaces may be nested
+//  with "::".  A null or empty namespace puts everything in the global one.
+class DataMapCodeGenerator {
+public:
+    // Methods
+    // RETURNS: false if name or nameSpace isn't usable.
+    static bool GenerateHeader (const char * name, const char * nameSpace, std::string * out);
+
+    // includeName is what the source's #include of the header says; the
+    //  header isn't included if it's null.
+    // RETURNS: false if name or nameSpace isn't usable.
+    static bool GenerateSource (
+        const DataNode & root,
+        const char *     name,
+        const char *     nameSpace,
+        const char *     includeName,
+        std::string *    out
+    );
+
+    // generates both, and writes each only if it has changed, so build
+    //  systems don't recompile what doesn't need it.  The source #includes
+    //  the header by its file name.
+    // RETURNS: false if either can't be generated or written.
+    static bool WriteFiles (
+        const DataNode & root,
+        const char *     name,
+        const char *     nameSpace,
+        const char *     headerPath,
+        const char *     sourcePath
+    );
+
+    DataMapCodeGenerator (void) = delete;
+};
+
+} // namespace CSaruDataMap
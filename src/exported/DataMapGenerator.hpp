@@ -0,0 +1,200 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#pragma once
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+    #define CSARU_DATAMAP_HAS_COROUTINES 1
+    #include <coroutine>
+    #include <exception>
+    #include <iterator>
+    #include <memory>
+    #include <type_traits>
+#else
+    #define CSARU_DATAMAP_HAS_COROUTINES 0
+#endif
+
+#include <string>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+
+#if CSARU_DATAMAP_HAS_COROUTINES
+
+namespace CSaruDataMap {
+
+// A lazily-run sequence of T, produced by a coroutine which co_yields them
+//  one at a time.  Nothing runs until the first value is asked for, and the
+//  coroutine is suspended between values:
+//
+//      for (DataMapVisit & visit : Traverse(root))
+//          ...
+//
+// Each value is the coroutine's own object, good until the next one is
+//  asked for.  Exceptions thrown in the coroutine come out of begin() or
+//  ++.  Only one pass can be made.
+template <typename T>
+class DataMapGenerator {
+public:
+    // Types
+    struct promise_type {
+        T *                m_value     = nullptr;
+        std::exception_ptr m_exception;
+
+        DataMapGenerator get_return_object (void) {
+            return DataMapGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend (void) noexcept { return {}; }
+        std::suspend_always final_suspend (void) noexcept   { return {}; }
+        void return_void (void)                             {}
+        void unhandled_exception (void)                     { m_exception = std::current_exception(); }
+
+        std::suspend_always yield_value (T & value) noexcept {
+            m_value = std::addressof(value);
+            return {};
+        }
+        // a temporary lives in the coroutine until it's resumed.
+        std::suspend_always yield_value (std::remove_const_t<T> && value) noexcept {
+            m_value = std::addressof(value);
+            return {};
+        }
+
+        // co_await isn't for generators.
+        void await_transform (void) = delete;
+    };
+
+    class Iterator {
+    public:
+        typedef std::input_iterator_tag  iterator_category;
+        typedef std::ptrdiff_t           difference_type;
+        typedef std::remove_const_t<T>   value_type;
+        typedef T &                      reference;
+        typedef T *                      pointer;
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+
+    public:
+        Iterator (void) = default;
+        explicit Iterator (std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        inline reference operator* (void) const        { return *m_handle.promise().m_value; }
+        inline pointer operator-> (void) const         { return m_handle.promise().m_value; }
+
+        inline Iterator & operator++ (void) {
+            m_handle.resume();
+            DataMapGenerator::Rethrow(m_handle);
+            return *this;
+        }
+        inline void operator++ (int)                   { ++*this; }
+
+        friend inline bool operator== (const Iterator & it, std::default_sentinel_t) {
+            return !it.m_handle || it.m_handle.done();
+        }
+    };
+
+private:
+    // Data
+    std::coroutine_handle<promise_type> m_handle;
+
+    // Helpers
+    explicit DataMapGenerator (std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    static inline void Rethrow (std::coroutine_handle<promise_type> handle) {
+        if (handle.done() && handle.promise().m_exception)
+            std::rethrow_exception(handle.promise().m_exception);
+    }
+
+public:
+    // Methods
+    DataMapGenerator (DataMapGenerator && other) noexcept : m_handle(other.m_handle) {
+        other.m_handle = nullptr;
+    }
+    DataMapGenerator & operator= (DataMapGenerator && rhs) noexcept {
+        if (this != &rhs) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle     = rhs.m_handle;
+            rhs.m_handle = nullptr;
+        }
+        return *this;
+    }
+
+    // stops the coroutine where it is, if it hasn't finished.
+    ~DataMapGenerator () {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    // runs the coroutine up to its first value.
+    inline Iterator begin (void) {
+        if (m_handle) {
+            m_handle.resume();
+            Rethrow(m_handle);
+        }
+        return Iterator(m_handle);
+    }
+    inline std::default_sentinel_t end (void) const    { return {}; }
+
+    DISALLOW_COPY_AND_ASSIGN(DataMapGenerator)
+};
+
+// One node reached by Traverse(), and the way there.
+struct DataMapVisit {
+    const DataNode *                      m_node;
+    const std::vector<const DataNode *> * m_ancestors;  // the root first; empty at the root
+    const std::vector<int> *              m_indices;    // child index taken below each ancestor
+    bool                                  m_skipChildren;
+
+    inline int GetDepth (void) const                   { return int(m_indices->size()); }
+    inline const DataNode * GetParent (void) const     { return m_ancestors->empty() ? nullptr : m_ancestors->back(); }
+
+    // don't visit this node's descendants.
+    inline void SkipChildren (void)                    { m_skipChildren = true; }
+
+    // the path from the root, as DataPath reads it: "a.b[3].c".  Children of
+    //  Arrays are given by index, and children of Objects by name.
+    // NOTE: Names with '.' or '[' in them won't compile back to the same path.
+    std::string GetPath (void) const;
+};
+
+// every node under root, root first, depth-first in child order.
+// WARNING: Changing the tree's structure while this is suspended leaves it
+//  with bad pointers, as it does DataMapReaders.
+DataMapGenerator<DataMapVisit> Traverse (const DataNode & root);
+
+// reads a snapshot file (see DataMapBinary) whose root is an Object or Array,
+//  and yields the root's children one at a time, each parsed only when it's
+//  asked for.  Only the child being read is kept in memory, plus what's been
+//  read of the file past it.
+// *outComplete (which must outlive the generator) is set to true once every
+//  child has been read, and left false if the file can't be read or is
+//  broken.
+// NOTE: The same DataNode is refilled for each child; std::move() it, or copy
+//  from it, to keep one.
+DataMapGenerator<DataNode> StreamSnapshotElements (const char * path, bool * outComplete);
+
+} // namespace CSaruDataMap
+
+#endif // CSARU_DATAMAP_HAS_COROUTINES
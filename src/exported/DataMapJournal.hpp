@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataMapMutatorListener.hpp"
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Write-ahead journal of the changes made to a DataMap through DataMapMutators,
+//  kept in local files next to a binary snapshot (see DataMapBinary):
+//
+//      DataMapJournal journal;
+//      journal.Open("state/world", &root);     // recovers root
+//      DataMapMutator mutator(&root);
+//      mutator.SetListener(&journal);
+//      ...
+//      journal.Flush();                        // durable from here
+//
+// Each change becomes one record: what was done (set a node, insert, delete,
+//  or move a child), the node's index path, and the new value.  Records are
+//  buffered, and written with a single sync per Flush(); they're also
+//  flushed on their own once s_defaultAutoFlushBytes (or whatever
+//  SetAutoFlushBytes() says) have built up.  Each record carries its length
+//  and a checksum, so a record torn by a crash is found and dropped on the
+//  next Open().
+//
+// Files are numbered by generation:
+//      <prefix>.current         generation of the newest complete snapshot
+//      <prefix>.snapshot.<N>    the map as of the start of journal N
+//      <prefix>.journal.<N>     changes since
+// StartCompaction() starts journal N + 1 at once, and writes snapshot N + 1
+//  from a copy of the map on a background thread.  Once that's on disk, the
+//  older files are deleted.  Open() loads the newest snapshot and replays
+//  every journal from its generation on.
+//
+// Behind a DataMapTransaction (as its next listener), only committed changes
+//  are written.  Records for changes still in a transaction stay buffered
+//  until Commit(), and are dropped on Rollback().
+//
+// WARNING: Every change to the map must go through a Mutator with this as its
+//  listener (directly or through a transaction).  The result of each change
+//  is recorded when the next one is reported or on Flush(), so the map must
+//  not be changed any other way in between.
+class DataMapJournal : public DataMapMutatorListener {
+public:
+    // Type and Constants
+    static const std::uint32_t s_journalMagic          = 0x314A4453;   // "SDJ1", little-endian
+    static const std::size_t   s_defaultAutoFlushBytes = 64 * 1024;
+
+private:
+    // Types
+    enum class RecordKind : std::uint8_t {
+        Node,       // keep-children flag, then the node (without children if kept)
+        Insert,     // index, then the new child
+        Delete,     // index
+        Move        // from index, to index
+    };
+
+    // Helpers
+    std::string GetFilePath (const char * kind, std::uint64_t generation) const;
+    bool OpenJournalFile (bool isNew);
+    void BeginRecord (RecordKind kind, const DataNode * node);
+    void EndRecord (void);
+    void RecordPending (void);
+    void AutoFlush (void);
+    bool ApplyRecord (const std::uint8_t * data, std::size_t size);
+    std::size_t Replay (const std::uint8_t * data, std::size_t size);
+
+    // Data
+    DataNode *                m_root;
+    std::string               m_pathPrefix;
+    std::FILE *               m_file;
+    std::uint64_t             m_generation;
+    std::uint64_t             m_snapshotGeneration;
+
+    std::vector<std::uint8_t> m_buffer;             // records not yet written
+    std::size_t               m_recordStart;        // of the record being built
+    std::size_t               m_committedSize;      // m_buffer bytes from before the open transaction
+    bool                      m_inTransaction;
+    std::size_t               m_autoFlushBytes;
+    std::vector<int>          m_path;               // scratch
+
+    // the last change reported, if its result is still to be recorded.
+    bool                      m_hasPending;
+    RecordKind                m_pendingKind;        // Node or Insert
+    DataNode *                m_pendingNode;        // the node, or the parent
+    int                       m_pendingIndex;
+    bool                      m_pendingKeepChildren;
+
+    std::thread               m_compactor;
+    std::unique_ptr<DataNode> m_compactionCopy;
+    std::atomic<bool>         m_compacting;
+    bool                      m_compactionOk;
+
+public:
+    // Methods
+    DataMapJournal (void);
+
+    // Close()s.
+    ~DataMapJournal ();
+
+    // replaces root with the state kept under pathPrefix (an empty Object if
+    //  there's none), then starts journaling changes to it.
+    // RETURNS: false if the files are there but the snapshot can't be read,
+    //  or the journal can't be opened for writing.
+    bool Open (const char * pathPrefix, DataNode * root);
+
+    // flushes, and waits for any compaction.
+    // RETURNS: false if either failed.
+    bool Close (void);
+
+    inline bool IsOpen (void) const                    { return m_file != nullptr; }
+    inline std::uint64_t GetGeneration (void) const    { return m_generation; }
+    inline std::size_t GetBufferedBytes (void) const   { return m_buffer.size(); }
+
+    // 0 to only ever flush when asked.
+    inline void SetAutoFlushBytes (std::size_t bytes)  { m_autoFlushBytes = bytes; }
+
+    // writes every buffered record (outside an open transaction), then syncs
+    //  the journal file once.
+    // RETURNS: false if writing or syncing failed.
+    bool Flush (void);
+
+    // flushes, copies the map, and moves on to a new journal; the copy is
+    //  written as the new snapshot on a background thread.
+    // NOTE: Not while a transaction is open, or while compacting.
+    // WARNING: potentially slow.  Copies the entire map on this thread.
+    // RETURNS: false if compaction couldn't be started.
+    bool StartCompaction (void);
+
+    inline bool IsCompacting (void) const              { return m_compacting.load(); }
+
+    // RETURNS: whether the last compaction succeeded.
+    bool WaitForCompaction (void);
+
+    ///////
+    // DataMapMutatorListener (begin)
+
+    void BeforeNodeChange (DataNode * node, bool keepChildren) override;
+    void BeforeInsert (DataNode * parent, int index) override;
+    void BeforeDelete (DataNode * parent, int index) override;
+    void BeforeMove (DataNode * parent, int fromIndex, int toIndex) override;
+    void OnTransactionBegin (void) override;
+    void OnTransactionCommit (void) override;
+    void OnTransactionRollback (void) override;
+
+    // DataMapMutatorListener (end)
+    ///////
+
+    DISALLOW_COPY_AND_ASSIGN(DataMapJournal)
+};
+
+} // namespace CSaruDataMap
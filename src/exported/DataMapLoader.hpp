@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataMapParseCache.hpp"
+#include "DataNode.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace CSaruDataMap {
+
+// Loads many files at once.  One I/O thread reads files in the order asked
+//  for, each with a few large sequential reads, and hands each file off to
+//  a WorkStealingPool to be parsed while it reads the next:
+//
+//      WorkStealingPool pool;
+//      DataMapLoader    loader(&pool);
+//      std::future<std::unique_ptr<DataNode>> world = loader.Load("world.json", &ParseJson);
+//      std::future<std::unique_ptr<DataNode>> items = loader.Load("items.json", &ParseJson);
+//      ...
+//      std::unique_ptr<DataNode> worldRoot = world.get();    // null if it failed
+//
+// Parsers are DataMapParseCache::Parsers, and may run on several pool
+//  threads at once.
+//
+// NOTE: The pool must outlive the loader.
+// WARNING: A pool task which waits on a load should HelpUntil() it's ready,
+//  not block on the future; the parse may be queued behind it.
+class DataMapLoader {
+public:
+    // Types
+    typedef DataMapParseCache::Parser Parser;
+
+    // given the new tree, or null if the file couldn't be read or parsed.
+    //  Called on a pool thread.
+    typedef std::function<void (std::unique_ptr<DataNode> root)> Callback;
+
+private:
+    // Types
+    struct Request {
+        std::string m_path;
+        Parser      m_parser;
+        Callback    m_callback;
+    };
+
+    // Type and Constants
+    static const std::size_t s_readSize = 1 << 20;
+
+    // Data
+    WorkStealingPool *      m_pool;
+    std::deque<Request>     m_requests;
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    bool                    m_stopping;
+    std::thread             m_ioThread;
+
+    // Helpers
+    void IoMain (void);
+    // RETURNS: false if path can't be opened or read.
+    static bool ReadWholeFile (const char * path, std::vector<std::uint8_t> * outData);
+
+public:
+    // Methods
+    explicit DataMapLoader (WorkStealingPool * parsePool);
+
+    // reads every file already asked for, and hands them to the pool, before
+    //  returning.  Parses may still be running.
+    ~DataMapLoader ();
+
+    // queues path to be read and parsed.
+    std::future<std::unique_ptr<DataNode>> Load (const char * path, const Parser & parser);
+
+    // the same, but calls done with the result instead.
+    void Load (const char * path, const Parser & parser, const Callback & done);
+
+    DataMapLoader (void) = delete;
+    DISALLOW_COPY_AND_ASSIGN(DataMapLoader)
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+namespace CSaruDataMap {
+
+class DataNode;
+
+// Told by a DataMapMutator about each change it is about to make (see
+//  DataMapMutator::SetListener()).  Each call comes just before the change,
+//  while the map still shows what is being changed, and AfterChange() once it
+//  has been made.
+//
+// DataMapTransaction, DataMapJournal, and DataMapSnapshotter are listeners.  A listener may pass
+//  calls on to another, so that a transaction can be journaled.
+class DataMapMutatorListener {
+public:
+    virtual ~DataMapMutatorListener () {}
+
+    // node's name, type, or value is about to change.  Unless keepChildren,
+    //  its children are about to be deleted or replaced.
+    virtual void BeforeNodeChange (DataNode * node, bool keepChildren) = 0;
+
+    // a new child is about to be inserted at index (which may be the end).
+    //  If parent isn't a container yet, it is about to become an Object.
+    virtual void BeforeInsert (DataNode * parent, int index) = 0;
+
+    virtual void BeforeDelete (DataNode * parent, int index) = 0;
+
+    virtual void BeforeMove (DataNode * parent, int fromIndex, int toIndex) = 0;
+
+    // the change (or changes) announced since the last call are done.  May
+    //  also come when nothing was announced.
+    virtual void AfterChange (void) {}
+
+    // a transaction has begun.  Changes reported from here on may yet be
+    //  undone.  Until it ends, the transaction keeps every node it's told is
+    //  being deleted or replaced (children included) alive in its log; they
+    //  needn't be moved out of the map to be kept.
+    virtual void OnTransactionBegin (void) {}
+
+    // the transaction is committing, and about to free the nodes it kept.  A
+    //  listener which still needs any of them may move them out of *logged.
+    virtual void BeforeTransactionCommit (std::vector<DataNode> * logged) { (void)logged; }
+
+    // the changes reported since OnTransactionBegin() are kept.
+    virtual void OnTransactionCommit (void) {}
+
+    // the changes reported since OnTransactionBegin() have been undone,
+    //  without going through a Mutator.
+    virtual void OnTransactionRollback (void) {}
+};
+
+} // namespace CSaruDataMap
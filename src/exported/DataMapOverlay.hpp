@@ -0,0 +1,189 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+class DataKey;
+
+// A read-only stack of DataMaps seen as one, without copying any of them.
+//  Layer 0 is at the bottom; each layer added goes on top and shadows those
+//  below it:
+//
+//      DataMapOverlay config;
+//      config.AddLayer(&defaults);     // 0
+//      config.AddLayer(&environment);  // 1
+//      config.AddLayer(&host);         // 2
+//      DataMapOverlayReader reader(&config);
+//      reader.ToChild("net").ToChild("port").ReadInt();
+//
+// Where a node is an Object in the topmost layers that have it, those layers'
+//  children are merged, key by key.  Any other node (an Array, a value, or an
+//  Object sitting on top of one of those) replaces whatever is under it
+//  outright.
+//
+// The layers aren't owned.  Reloading one is SetLayer() with its new root; the
+//  others are untouched.
+class DataMapOverlay {
+public:
+    // Type and Constants
+    static const int s_maxLayers = 8;
+
+private:
+    friend class DataMapOverlayReader;
+
+    // Types
+    // one key of a merged Object: the first child with that name in each
+    //  layer (null where a layer has none), and the lowest layer with one.
+    struct MergedChild {
+        const DataNode * m_nodes[s_maxLayers];
+        int              m_layer;
+    };
+
+    // Data
+    std::vector<const DataNode *> m_layers;
+
+    // Helpers
+    // lists the merged children of nodes, in Flatten() order, looking each
+    //  name up once in a table built for this one Object.
+    static void MergeChildren (const DataNode * const * nodes, int layerCount, std::vector<MergedChild> * outChildren);
+    void FlattenNode (const DataNode * const * nodes, DataNode * outNode) const;
+
+public:
+    // Methods
+    DataMapOverlay (void) {}
+
+    // RETURNS: the new layer's index, or -1 if there are already s_maxLayers.
+    int AddLayer (const DataNode * root);
+
+    // a null root leaves the layer in place but empty.
+    // WARNING: DataMapOverlayReaders on this overlay must be made anew.
+    void SetLayer (int layer, const DataNode * root);
+
+    inline int GetLayerCount (void) const              { return int(m_layers.size()); }
+    inline const DataNode * GetLayer (int layer) const { return m_layers[layer]; }
+
+    void Clear (void);
+
+    // writes the merged result to outRoot, in one pass over the layers.
+    //  outRoot keeps its own name.  Merged Objects list the bottom layer's
+    //  keys first, then each layer's new keys in turn.
+    void Flatten (DataNode * outRoot) const;
+
+    DISALLOW_COPY_AND_ASSIGN(DataMapOverlay)
+};
+
+// Walks a DataMapOverlay like a DataMapReader walks a single map.  At each
+//  step it keeps the node in every layer that still contributes, in a fixed
+//  array.  A merged Object's children are listed the first time they're
+//  counted or stepped into, and kept until the Reader pops back out of it.
+// WARNING: Like raw node pointers, these go bad if the structure of any layer
+//  changes while they're in use.
+class DataMapOverlayReader {
+private:
+    // Types
+    struct Frame {
+        const DataNode * m_nodes[DataMapOverlay::s_maxLayers];  // null where a layer has nothing, or is shadowed
+        int              m_top;                                 // topmost layer with a node; -1 if none
+
+        // built by GetMergedChildren(); only for nodes with several layers.
+        mutable std::vector<DataMapOverlay::MergedChild> m_merged;
+        mutable bool                                     m_isMerged;
+    };
+
+    // Data
+    const DataMapOverlay * m_overlay;
+    Frame                  m_frame;
+    std::vector<Frame>     m_frameStack;    // does *not* contain m_frame.
+
+    // Helpers
+    const std::vector<DataMapOverlay::MergedChild> & GetMergedChildren (void) const;
+    // moves m_frame onto the stack, leaving its nodes for the child to start
+    //  from.
+    void PushFrame (void);
+
+public:
+    // Methods
+    explicit DataMapOverlayReader (const DataMapOverlay * overlay);
+
+    // the node the current value comes from: the one in the topmost layer.
+    inline const DataNode * GetCurrentNode (void) const { return m_frame.m_top < 0 ? nullptr : m_frame.m_nodes[m_frame.m_top]; }
+    inline int GetCurrentLayer (void) const             { return m_frame.m_top; }
+
+    inline bool IsValid (void) const                    { return m_frame.m_top >= 0; }
+
+    // RETURNS: the number of children after merging.
+    // NOTE: For a merged Object, the first call lists its children, hashing
+    //  each name once; later calls at the same node are free.
+    int GetChildCount (void) const;
+
+    ///////
+    // navigation (begin)
+
+    // return to the parent node.
+    // NOTE: If this is used on the root node, the Reader becomes invalidated.
+    DataMapOverlayReader & PopNode (void);
+
+    // children are counted as GetChildCount() and Flatten() order them.  If
+    //  there is no child at the given index, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    // NOTE: For a merged Object, this uses the same list as GetChildCount().
+    DataMapOverlayReader & ToChild (int index);
+
+    // if no layer has a child with such a name, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    DataMapOverlayReader & ToChild (const char * name);
+
+    // same as above, but matches on the key's precomputed hash first.
+    DataMapOverlayReader & ToChild (const DataKey & key);
+
+    // navigation (end)
+    ///////
+    // reading (begin)
+
+    // all of these read the topmost layer's node.
+    const char * ReadName (void) const;
+    bool         ReadBool (void) const;
+    int          ReadInt (void) const;
+    float        ReadFloat (void) const;
+    const char * ReadString (void) const;
+
+    // RETURNS: true on success (and the out parameter is written to).
+    //          false otherwise, and the out parameter is not written to.
+    bool ReadBoolSafe (bool * outBool) const;
+    bool ReadIntSafe (int * outInt) const;
+    bool ReadFloatSafe (float * outFloat) const;
+    bool ReadStringSafe (char * outString, int bufferSizeInElements) const;
+
+    // reading (end)
+    ///////
+
+    DataMapOverlayReader (void) = delete;
+};
+
+} // namespace CSaruDataMap
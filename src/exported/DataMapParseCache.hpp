@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Keeps the parsed form of source files (JSON, or anything else) as
+//  OffsetDataMapImages in a local cache directory, so that loading a file
+//  which hasn't changed since it was last parsed skips the parse:
+//
+//      DataMapParseCache cache("cache/config", &ParseJson);
+//      DataNode root;
+//      cache.Load("config/world.json", &root);
+//
+// A cache entry is keyed by the source's path, size, modification time,
+//  and a hash of its contents, all of which must match for a hit.  On a
+//  miss the parser is run, and its result replaces the entry.
+//
+// Each source path has one entry file in the directory, named by a hash of
+//  the path: a small header holding the key and a hash of the image, then
+//  the image, which is checked against both before use.  Entries are
+//  replaced atomically, so a crash or a concurrent load never sees half of
+//  one.
+//
+// Loads may run on several threads at once, as long as the parser can.
+//  Writers racing to refresh one entry each write their own temp file; the
+//  last rename wins, and both results are whole.
+//
+// NOTE: The directory isn't made; it must exist.
+class DataMapParseCache {
+public:
+    // Types
+    // turns a source file's contents into a tree.
+    // RETURNS: false if the contents can't be parsed.
+    typedef std::function<bool (const std::uint8_t * data, std::size_t size, DataNode * outRoot)> Parser;
+
+private:
+    // Types
+    struct Source {
+        std::string               m_path;
+        std::uint64_t             m_size;
+        std::int64_t              m_modifiedTime;     // in nanoseconds, where the OS has them
+        std::uint64_t             m_contentHash;      // 0 until m_contents is read
+        std::vector<std::uint8_t> m_contents;
+        bool                      m_hasContents;
+    };
+
+    // Type and Constants
+    static const std::uint32_t s_magic = 0x32435044;  // "DPC2", little-endian
+
+    // Data
+    std::string      m_directory;
+    Parser           m_parser;
+    bool             m_verifyContents;
+    std::atomic<int> m_hitCount;
+    std::atomic<int> m_missCount;
+
+    // Helpers
+    bool StatSource (const char * path, Source * outSource) const;
+    bool ReadSource (Source * source) const;
+    std::string GetEntryPath (const std::string & sourcePath) const;
+    // RETURNS: true if source's entry is current, with its image in outImage.
+    bool FindImage (Source * source, std::vector<std::uint8_t> * outImage) const;
+    // parses source, and writes its entry.
+    bool ParseSource (Source * source, DataNode * outRoot, std::vector<std::uint8_t> * outImage);
+
+public:
+    // Methods
+    DataMapParseCache (const char * directory, const Parser & parser);
+
+    // with this off, a matching size and modification time are enough for a
+    //  hit, and the source isn't read at all.  On by default.  Set it before
+    //  loading from several threads.
+    inline void SetVerifyContents (bool verify)        { m_verifyContents = verify; }
+    inline bool GetVerifyContents (void) const         { return m_verifyContents; }
+
+    // replaces outRoot with the tree in sourcePath, from the cache if it can.
+    // RETURNS: false if sourcePath can't be read, or a parse was needed and
+    //  failed.
+    bool Load (const char * sourcePath, DataNode * outRoot);
+
+    // the same, but gives the image, for reading in place with an
+    //  OffsetDataMapReader.
+    bool LoadImage (const char * sourcePath, std::vector<std::uint8_t> * outImage);
+
+    // removes sourcePath's entry, if it has one.
+    void Forget (const char * sourcePath);
+
+    // RETURNS: how many loads the cache served, and how many it had to parse.
+    inline int GetHitCount (void) const                { return m_hitCount.load(std::memory_order_relaxed); }
+    inline int GetMissCount (void) const               { return m_missCount.load(std::memory_order_relaxed); }
+
+    DataMapParseCache (void) = delete;
+    DISALLOW_COPY_AND_ASSIGN(DataMapParseCache)
+};
+
+} // namespace CSaruDataMap
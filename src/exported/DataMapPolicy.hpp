@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <stdexcept>
+
+namespace CSaruDataMap {
+
+// Safety policies for BasicDataMapReader and BasicDataMapMutator.  Each
+//  provides Check(condition, message), called before anything which would
+//  dereference a null node or read the wrong member of a node's data.
+// RETURNS (Check): true if the operation should go ahead.
+
+// no checks at all.  Check() is constant true, so every branch folds away.
+struct UncheckedPolicy {
+    inline bool Check (bool, const char *) const { return true; }
+};
+
+// asserts in debug builds, and goes ahead regardless.  DataMapReader and
+//  DataMapMutator use this.
+struct AssertingPolicy {
+    inline bool Check (bool condition, const char * message) const {
+        assert(condition && message);
+        (void)message;
+        return true;
+    }
+};
+
+class DataMapError : public std::logic_error {
+public:
+    explicit DataMapError (const char * message) : std::logic_error(message) {}
+};
+
+// throws a DataMapError on any failed check.
+struct ThrowingPolicy {
+    inline bool Check (bool condition, const char * message) const {
+        if (!condition)
+            throw DataMapError(message);
+        return true;
+    }
+};
+
+// skips the operation and remembers the first failure.  Reads which are
+//  skipped return zero, false, or nullptr.
+class ErrorReturningPolicy {
+private:
+    // Data
+    mutable const char * m_error;
+
+public:
+    // Methods
+    ErrorReturningPolicy (void) : m_error(nullptr) {}
+
+    inline bool Check (bool condition, const char * message) const {
+        if (condition)
+            return true;
+        if (m_error == nullptr)
+            m_error = message;
+        return false;
+    }
+
+    inline bool HasError (void) const           { return m_error != nullptr; }
+
+    // RETURNS: the first failed check's message since construction or the
+    //  last ClearError(); nullptr if there hasn't been one.
+    inline const char * GetError (void) const   { return m_error; }
+    inline void ClearError (void)               { m_error = nullptr; }
+};
+
+} // namespace CSaruDataMap
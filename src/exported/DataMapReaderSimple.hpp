@@ -20,12 +20,68 @@ freely, subject to the following restrictions:
 
 #pragma once
 
+#include <string>
+
+#include "DataKey.hpp"
 #include "DataMapReader.hpp"
+#include "DataPath.hpp"
 
 namespace CSaruDataMap {
 
 class DataMapReaderSimple {
 
+public: // Types
+
+    // One destination for ReadFields().  Build these with the static helpers:
+    //  DataMapReaderSimple::Field::Int("hp"_dk, &hp, 100)
+    struct Field {
+        enum class Type { Bool, Int, Float, String };
+
+        DataKey m_key;
+        Type    m_type;
+        void *  m_dest;
+        union {
+            bool         m_bool;
+            int          m_int;
+            float        m_float;
+            const char * m_string;
+        }       m_default;
+
+        Field (const DataKey & key, Type type, void * dest) :
+            m_key(key),
+            m_type(type),
+            m_dest(dest)
+        {
+            m_default.m_string = nullptr;
+        }
+
+        static Field Bool (const DataKey & key, bool * dest, bool defaultValue) {
+            Field field(key, Type::Bool, dest);
+            field.m_default.m_bool = defaultValue;
+            return field;
+        }
+        static Field Int (const DataKey & key, int * dest, int defaultValue) {
+            Field field(key, Type::Int, dest);
+            field.m_default.m_int = defaultValue;
+            return field;
+        }
+        static Field Float (const DataKey & key, float * dest, float defaultValue) {
+            Field field(key, Type::Float, dest);
+            field.m_default.m_float = defaultValue;
+            return field;
+        }
+        static Field String (const DataKey & key, std::string * dest, const char * defaultValue) {
+            Field field(key, Type::String, dest);
+            field.m_default.m_string = defaultValue;
+            return field;
+        }
+    };
+
+private: // Constants
+
+    // ReadFields() batches up to half this many fields without allocating.
+    static const int s_fieldTableStackSize = 64;
+
 private: // Data
 
     DataMapReader m_reader;
@@ -43,6 +99,7 @@ public: // Queries / Commands
     bool IsValid () const;
     
     bool ToChild (const char * name);
+    bool ToChild (const DataKey & key);
     bool ToFirstChild ();
     bool ToNextSibling ();
     bool ToParent ();
@@ -65,6 +122,29 @@ public: // Queries / Commands
     std::wstring WString (const char * name) const;
     std::wstring WString (const char * name, const std::wstring & defaultValue) const;
 
+    // key lookups among the current node's children.  No Reader is copied, and
+    //  children are matched on the key's precomputed hash first.
+    bool Bool (const DataKey & key, bool defaultValue) const;
+    int Int (const DataKey & key, int defaultValue) const;
+    float Float (const DataKey & key, float defaultValue) const;
+    std::string String (const DataKey & key, const std::string & defaultValue) const;
+
+    // path lookups from the current node.  No Reader is copied, and the path's
+    //  cached resolution is reused while the map's structure is unchanged.
+    bool Bool (const DataPath & path, bool defaultValue) const;
+    int Int (const DataPath & path, int defaultValue) const;
+    float Float (const DataPath & path, float defaultValue) const;
+    std::string String (const DataPath & path, const std::string & defaultValue) const;
+
+    // fills every field from the current node's children in a single pass,
+    //  instead of one scan of the children per field.  Fields which are
+    //  missing, or whose child is the wrong type, get their default.  As with
+    //  the name lookups, the first child with a matching name is the one used.
+    // RETURNS: how many fields were read from the map rather than defaulted.
+    int ReadFields (Field * fields, int fieldCount) const;
+    template <int N>
+    int ReadFields (Field (&fields)[N]) const { return ReadFields(fields, N); }
+
 };
 
 } // namespace CSaruDataMap
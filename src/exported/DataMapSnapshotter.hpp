@@ -0,0 +1,200 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataMapMutatorListener.hpp"
+#include "DataNode.hpp"
+#include "DataNodeHandle.hpp"
+
+namespace CSaruDataMap {
+
+// Writes a snapshot of a DataNode tree (in DataMapBinary's snapshot format)
+//  on a background thread, while Mutators carry on changing the tree:
+//
+//      DataMapSnapshotter snapshotter(&root);
+//      mutator.SetListener(&snapshotter);
+//      snapshotter.Start("state.snapshot");
+//      ...                             // keep writing through mutator
+//      bool ok = snapshotter.Wait();
+//
+// The file holds the tree exactly as it was at Start().  A background thread
+//  walks the tree in pre-order, a chunk of nodes at a time.  Before a Mutator
+//  changes anything the walk hasn't reached yet, the snapshotter keeps what
+//  the walk needs of it (copy-on-write, one node at a time):
+//      - a node's name and value are copied before they're overwritten;
+//      - a container's list of children is taken as DataNodeHandles the
+//        first time they're inserted into, deleted from, or moved around;
+//      - deleted children, and children being replaced, are moved out of the
+//        tree whole and kept until the snapshot is done.  Inside a
+//        transaction they're left to it instead, and found again by handle;
+//        it hands them over if it commits before the snapshot is done.
+// Nothing is deep copied.  A change costs a walk up to the root to see where
+//  it stands relative to the walk, plus, once per container per snapshot,
+//  O(children) to list them.  Mutators may also wait for the background
+//  thread to finish its current chunk.
+//
+// WARNING: While a snapshot runs, the tree must only be changed through
+//  Mutators listening to this snapshotter (directly, or further down a
+//  chain).  A DataMapTransaction may pass calls on to a snapshotter, but not
+//  the other way around, and must not be rolled back while a snapshot runs:
+//  Rollback() changes the tree directly.  Rolling back once Wait() returns
+//  is fine; the transaction's log is complete.
+class DataMapSnapshotter : public DataMapMutatorListener {
+public:
+    // Type and Constants
+    static const int s_nodesPerChunk  = 256;
+    static const int s_bytesPerWrite  = 64 * 1024;
+
+private:
+    // Types
+    // what the snapshot still needs of a node the tree no longer shows.
+    struct Saved {
+        bool                        m_hasHeader;    // name, type, and value in m_header
+        bool                        m_hasChildren;  // children in m_children
+        bool                        m_hasChildCount;// only appended to: the first m_childCount
+        int                         m_childCount;
+        DataNode                    m_header;
+        std::vector<DataNodeHandle> m_children;
+        // m_children index of each child, by handle slot.
+        std::unordered_map<std::uint32_t, int> m_indexOfSlot;
+
+        Saved (void) : m_hasHeader(false), m_hasChildren(false), m_hasChildCount(false), m_childCount(0) {}
+    };
+
+    // a container whose header has been written, but not all its children.
+    struct Frame {
+        DataNodeHandle m_node;
+        int            m_next;
+        int            m_count;
+    };
+
+    enum class Progress {
+        Written,    // written out already, or not part of the snapshot
+        Open,       // header written, children under way
+        Pending     // not reached yet
+    };
+
+    // Data
+    DataNode *                             m_root;
+    DataMapMutatorListener *               m_next;
+
+    // guards the tree (while a snapshot runs) and everything below.  Held by
+    //  the background thread while it walks a chunk, and by Mutators from a
+    //  Before call to AfterChange().
+    std::mutex                             m_mutex;
+    std::atomic<bool>                      m_walking;
+    std::vector<Frame>                     m_frames;
+    std::unordered_map<std::uint32_t, Saved> m_saved;   // by handle slot
+    std::vector<std::unique_ptr<DataNode>> m_detached;  // moved out of the tree
+    std::vector<const DataNode *>          m_chain;     // scratch
+    int                                    m_progressFrame; // set by GetProgress()
+
+    // Mutator-side only
+    bool                                   m_mutatorLocked;
+    // an upstream transaction is keeping what's deleted and replaced.
+    bool                                   m_inTransaction;
+
+    // background-thread only
+    std::thread                            m_thread;
+    std::atomic<bool>                      m_finished;
+    std::FILE *                            m_file;
+    std::string                            m_path;
+    std::string                            m_tempPath;
+    std::vector<std::uint8_t>              m_buffer;
+    bool                                   m_ok;
+
+    // Helpers
+    // RETURNS: true if a snapshot needs to know about the change.
+    bool LockForChange (void);
+    // also leaves the deepest frame on node's path in m_progressFrame.
+    Progress GetProgress (const DataNode * node);
+    Saved * FindSaved (const DataNode * node);
+    // RETURNS: how many children node had at Start().
+    int GetStartChildCount (DataNode * node, Progress progress);
+    void SaveHeader (DataNode * node);
+    void SaveChildren (DataNode * node, Progress progress);
+    // for a pending node only ever appended to.
+    void SaveChildCount (DataNode * node, int childCount);
+    bool WasChildAtStart (const DataNode * parent, const DataNode * child);
+    void DetachChild (DataNode * parent, int index);
+    void DetachChildren (DataNode * node);
+
+    // appends node up to its children, and opens a frame for them if any.
+    void WriteNodeHeader (DataNode * node);
+    // RETURNS: false once the whole tree has been written.
+    bool WriteChunk (void);
+    void ThreadMain (void);
+
+public:
+    // Methods
+    explicit DataMapSnapshotter (DataNode * root, DataMapMutatorListener * next = nullptr);
+
+    // waits for any snapshot still running.
+    ~DataMapSnapshotter ();
+
+    inline DataNode * GetRoot (void) const             { return m_root; }
+
+    // starts writing a snapshot of the tree as it is now to path, replacing
+    //  it once complete.
+    // RETURNS: false if a snapshot is already running, or path can't be
+    //  written.
+    bool Start (const char * path);
+
+    // RETURNS: true until the snapshot has been written out (or failed).
+    inline bool IsRunning (void) const                 { return m_thread.joinable() && !m_finished.load(); }
+
+    // RETURNS: true if the last snapshot was written out completely.
+    bool Wait (void);
+
+    ///////
+    // DataMapMutatorListener (begin)
+    // every call is passed on to the next listener first, if there is one.
+
+    void BeforeNodeChange (DataNode * node, bool keepChildren) override;
+    void BeforeInsert (DataNode * parent, int index) override;
+    void BeforeDelete (DataNode * parent, int index) override;
+    void BeforeMove (DataNode * parent, int fromIndex, int toIndex) override;
+    void AfterChange (void) override;
+    void OnTransactionBegin (void) override;
+    void BeforeTransactionCommit (std::vector<DataNode> * logged) override;
+    void OnTransactionCommit (void) override;
+    void OnTransactionRollback (void) override;
+
+    // DataMapMutatorListener (end)
+    ///////
+
+    DISALLOW_COPY_AND_ASSIGN(DataMapSnapshotter)
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataMapMutator.hpp"
+#include "DataMapMutatorListener.hpp"
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// An undo log for changes made through DataMapMutators:
+//
+//      DataMapTransaction transaction(&root);
+//      DataMapMutator mutator = transaction.GetMutator();
+//      transaction.Begin();
+//      ...
+//      if (schema.Validate(root))
+//          transaction.Commit();
+//      else
+//          transaction.Rollback();
+//
+// While a transaction is active, each Mutator it's attached to logs what it's
+//  about to overwrite before every change.  Values and names are copied;
+//  deleted or overwritten children are moved into the log whole, so nothing is
+//  deep copied.  Rollback() undoes the log in reverse, in O(changes); Commit()
+//  just forgets it.
+//
+// Changes made other than through an attached Mutator aren't logged, and
+//  Rollback() can't undo them.
+//
+// Every call is passed on to the next listener, if one is given; a
+//  DataMapJournal there records only what's committed.  The next listener is
+//  told of each change before it's logged, so it sees the map as it was.
+//  While active, the transaction keeps what it logs; at Commit() the next
+//  listener may take what it still needs of that (see DataMapSnapshotter).
+//
+// Readers which must never see a half-done transaction should read from a
+//  ConcurrentDataMap, with the transaction on the version being written, and
+//  Publish() only after Commit().  After Rollback() the version being written
+//  is back how it was at Begin(), with no copy of it taken.
+class DataMapTransaction : public DataMapMutatorListener {
+private:
+    // Types
+    struct Entry {
+        enum class Kind {
+            Node,       // a node's name, type, or value; maybe its children
+            Insert,     // a child added at m_index
+            Delete,     // the child at m_index removed
+            Move        // the child at m_index moved to m_toIndex
+        };
+
+        Kind m_kind;
+        int  m_pathBegin;       // into m_pathIndices: the node, or the parent
+        int  m_pathLength;
+        int  m_index;
+        int  m_toIndex;
+        int  m_saved;           // into m_savedNodes; Node and Delete only
+        bool m_keptChildren;    // Node only
+    };
+
+    // Data
+    DataNode *               m_root;
+    DataMapMutatorListener * m_next;
+    bool                     m_active;
+    std::vector<Entry>       m_entries;
+    std::vector<int>         m_pathIndices;
+    std::vector<DataNode>    m_savedNodes;
+
+    // Helpers
+    Entry & AddEntry (Entry::Kind kind, const DataNode * node);
+    void LogNodeChange (DataNode * node, bool keepChildren);
+    DataNode * FindNode (const Entry & entry) const;
+    void Forget (void);
+
+public:
+    // Methods
+    explicit DataMapTransaction (DataNode * root, DataMapMutatorListener * next = nullptr);
+
+    // rolls back if still active.
+    ~DataMapTransaction ();
+
+    inline DataNode * GetRoot (void) const             { return m_root; }
+
+    // RETURNS: a Mutator at the root, attached to this transaction.
+    DataMapMutator GetMutator (void);
+
+    // NOTE: Transactions don't nest.
+    void Begin (void);
+    void Commit (void);
+    void Rollback (void);
+
+    inline bool IsActive (void) const                  { return m_active; }
+    inline int GetChangeCount (void) const             { return int(m_entries.size()); }
+
+    ///////
+    // DataMapMutatorListener (begin)
+    // these log only while the transaction is active.  Deleted children, and
+    //  those of nodes whose children are being replaced, are moved into the
+    //  log before the change, leaving empty nodes behind.
+
+    void BeforeNodeChange (DataNode * node, bool keepChildren) override;
+    void BeforeInsert (DataNode * parent, int index) override;
+    void BeforeDelete (DataNode * parent, int index) override;
+    void BeforeMove (DataNode * parent, int fromIndex, int toIndex) override;
+    void AfterChange (void) override;
+
+    // DataMapMutatorListener (end)
+    ///////
+
+    DISALLOW_COPY_AND_ASSIGN(DataMapTransaction)
+};
+
+} // namespace CSaruDataMap
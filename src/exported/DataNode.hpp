@@ -20,12 +20,20 @@ freely, subject to the following restrictions:
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
+#include "DataKey.hpp"
+#include "DataNodeHandle.hpp"
+
 namespace CSaruDataMap {
 
 // ASSUMPTION: Does not contain a vtable. // TODO: Double-check this requirement.
 // ASSUMPTION: Uses 1-byte chars.
+// NOTE: The name hash, parent link, handle slot, structure version, and
+//  cached subtree hash kept below add 40 bytes to every node on 64-bit
+//  targets (160 bytes, up from 120), whether or not they're used.
 class DataNode {
 public:
     // Type and Constants
@@ -47,6 +55,10 @@ public:
 public:
     // Data
     char m_name[s_nameSize];
+    // DataKey::HashName() of m_name.  Kept up to date by SetName() and
+    //  SetNameSecure().
+    // WARNING: Writing to m_name directly does not update this.
+    std::uint32_t m_nameHash;
     Type m_type;
 
     union {
@@ -58,18 +70,75 @@ public:
 
     std::vector<DataNode> m_children;
 
+    // kept up to date by every method which changes m_children.  A node which
+    //  isn't anyone's child has a null parent and an index of -1.
+    // NOTE: Always present (16 bytes per node on 64-bit targets), not a
+    //  build option: DataNodeCursor, DataPath, journals, transactions and
+    //  snapshots all find their way up the tree through these.
+    // WARNING: Changing m_children directly does not update these.
+    DataNode * m_parent;
+    int        m_indexInParent;
+
+    // 0 until GetHandle() is first called on this node.  Atomic only so that
+    //  GetHandle() can be called on a tree other threads are reading.
+    std::atomic<std::uint32_t> m_handleSlot;
+
+    // bumped whenever children are added to, removed from, or replaced in
+    //  this node or any of its descendants.  Cursors remember it to notice
+    //  when their node pointers may have gone bad.
+    std::uint32_t m_structureVersion;
+
+    // GetSubtreeHash() of a container, or 0 if it hasn't been worked out
+    //  since the subtree last changed.  Leaves are hashed on demand.  If a
+    //  node's hash is cached, so are those of all its container descendants,
+    //  which lets invalidation stop at the first ancestor without one.
+    mutable std::atomic<std::uint64_t> m_subtreeHash;
+
+private:
+    // rolls back changes by putting nodes' fields and children back directly.
+    friend class DataMapTransaction;
+    // preserves what a running snapshot has yet to write out.
+    friend class DataMapSnapshotter;
+
+    // Helpers
+    // points the parent links of children [firstIndex, last] back at this.
+    void RelinkChildren (int firstIndex);
+
+    // bumps m_structureVersion on this node and every ancestor, and drops
+    //  their cached subtree hashes.
+    void BumpStructureVersion (void);
+
+    // drops the cached subtree hash of this node and its ancestors.
+    void InvalidateSubtreeHash (void);
+
 public:
     // Methods
-    DataNode (void) : m_type(Type::Unused)  {
+    DataNode (void) : m_nameHash(DataKey::HashName("", 0)), m_type(Type::Unused), m_parent(nullptr), m_indexInParent(-1), m_handleSlot(0), m_structureVersion(0), m_subtreeHash(0)  {
         m_name[0] = '\0';
     }
 
+    ~DataNode ();
+
     // WARNING: potentially VERY SLOW
+    // NOTE: The copy is a new node; it does not share other's handle.
     DataNode (const DataNode & other);
 
     // WARNING: potentially VERY SLOW
+    // NOTE: This node and its old children are overwritten, so any handle to
+    //  them is invalidated.  Keeps this node's own parent and index in its
+    //  parent.
     DataNode & operator=(const DataNode & rhs);
 
+    // takes over other's children, handle, parent, and index in its parent
+    //  without copying them.  This is what std::vector uses when it has to
+    //  reallocate or shift m_children.
+    DataNode (DataNode && other) noexcept;
+
+    // this node is overwritten, so any handle to it is invalidated.  other's
+    //  children and handle are taken over without copying them.  Keeps this
+    //  node's own parent and index in its parent.
+    DataNode & operator=(DataNode && rhs) noexcept;
+
     explicit DataNode (const char * name, Type type = Type::Null);
     explicit DataNode (const char * name, int int_data);
     explicit DataNode (const char * name, float m_floatdata);
@@ -117,6 +186,8 @@ public:
 
     inline const char * GetName (void) const { return m_name; }
 
+    inline std::uint32_t GetNameHash (void) const { return m_nameHash; }
+
     // new_name must be null-terminated
     DataNode * SetName (const char * new_name);
 
@@ -127,11 +198,22 @@ public:
 
     inline Type GetType (void) const        { return m_type; }
 
+    // RETURNS: a handle which keeps finding this node even after it is moved
+    //  by changes to its parent's children.  The first call on a node takes a
+    //  slot in the DataNodeHandleTable; later calls are cheap.
+    DataNodeHandle GetHandle (void);
+
+    // replaces this node's type, value, and children with copies of value's,
+    //  keeping its own name and handle.  Handles to the old children are
+    //  invalidated.  value may be anywhere, even under this node.
+    // WARNING: potentially VERY SLOW
+    DataNode * SetContents (const DataNode & value);
+
     // also deletes children if this is being changed to a type that cannot have
     //  children
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetType (Type type);
 
     // convenience function to check if the current node is either an object
@@ -139,34 +221,69 @@ public:
     inline bool IsContainerType (void) const { return m_type == Type::Object || m_type == Type::Array; }
 
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetInt (int new_int);
 
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetFloat (float new_float);
 
     // new_string must be null-terminated
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetString (const char * new_string);
 
     // size_in_elements should not include the NULL terminator.  If new_string
     //  is too large, as much of it as possible will be copied, and the internal
     //  copy will be NULL-terminated.
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetStringSecure (const char * new_string, int size_in_elements);
 
     // WARNING: If this DataNode has any children, then this action invalidates
-    //  any DataMapMutators/Readers that happen to be pointing to any of those
-    //  children without any way of detecting the invalidation.
+    //  any raw pointers to them.  DataMapMutators/Readers pointing at them see
+    //  the structure version change and Revalidate() on their next use.
     DataNode * SetBool (bool new_bool);
 
+    // RETURNS: nullptr if this node isn't anyone's child.
+    inline const DataNode * GetParent (void) const { return m_parent; }
+    inline DataNode * GetParent (void)       { return m_parent; }
+
+    // RETURNS: -1 if this node isn't anyone's child.
+    inline int GetIndexInParent (void) const { return m_indexInParent; }
+
+    // RETURNS: nullptr if there is no such sibling (or no parent).
+    inline const DataNode * GetNextSibling (void) const {
+        return m_parent ? m_parent->GetChildSafe(m_indexInParent + 1) : nullptr;
+    }
+    inline DataNode * GetNextSibling (void) {
+        return m_parent ? m_parent->GetChildSafe(m_indexInParent + 1) : nullptr;
+    }
+
+    // RETURNS: nullptr if there is no such sibling (or no parent).
+    inline const DataNode * GetPreviousSibling (void) const {
+        return m_parent ? m_parent->GetChildSafe(m_indexInParent - 1) : nullptr;
+    }
+    inline DataNode * GetPreviousSibling (void) {
+        return m_parent ? m_parent->GetChildSafe(m_indexInParent - 1) : nullptr;
+    }
+
+    inline std::uint32_t GetStructureVersion (void) const { return m_structureVersion; }
+
+    // RETURNS: a 64-bit hash of this node's type and value, and of the names
+    //  and subtree hashes of all its children, in order.  This node's own name
+    //  is not included.  Equal subtrees always hash the same, so differing
+    //  hashes mean the subtrees differ.
+    // NOTE: Cached on containers, so repeat calls are O(1) until something
+    //  under the node changes through DataNode's methods (which includes
+    //  everything DataMapMutator does).  Writing to m_data or m_name directly
+    //  does not invalidate the cache.
+    std::uint64_t GetSubtreeHash (void) const;
+
     inline int GetChildCount (void) const   { return static_cast<int>(m_children.size()); }
 
     inline bool HasChildren (void) const    { return !m_children.empty(); }
@@ -195,30 +312,56 @@ public:
     const DataNode * GetChildByName (const char * name) const;
     DataNode * GetChildByName (const char * name);
 
+    // same as above, but compares the key's precomputed hash against each
+    //  child's name hash first, and only compares bytes on a match.
+    const DataNode * GetChildByName (const DataKey & key) const;
+    DataNode * GetChildByName (const DataKey & key);
+
     // also changes type to Type::Object if this was previously not of a type which
     //  is permitted to have children.
-    // WARNING: Invalidates any DataMapMutators/Readers that happen to be
-    //  pointing to any of this DataNode's children without any way of detecting
-    //  the invalidation.
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
     DataNode * AppendNewChild (void);
 
-    // WARNING: potentially _*VERY SLOW *_.  Must shift all following children in
-    //  the m_children array by copying them one at a time.  This will cause them
-    //  to copy their m_name, data, type, and all their children (which then must
-    //  copy all their children, and so on).
-    // WARNING: Invalidates any DataMapMutators/Readers that happen to be
-    //  pointing to any of this DataNode's children without any way of detecting
-    //  the invalidation.
+    // makes room for count children, so that adding up to that many won't
+    //  reallocate m_children.
+    // WARNING: If m_children has to grow, this invalidates any raw pointers to
+    //  this DataNode's children, and bumps the structure version so that
+    //  DataMapMutators/Readers pointing at them Revalidate().
+    void ReserveChildren (int count);
+
+    // WARNING: potentially slow.  Must shift all following children in the
+    //  m_children array by moving them one at a time.  Their own children are
+    //  not copied.
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
     DataNode * InsertNewChild (int index);
 
-    // WARNING: Invalidates any DataMapMutators/Readers that happen to be
-    //  pointing to any of this DataNode's children without any way of detecting
-    //  the invalidation.
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
     void DeleteLastChild (void);
 
-    // WARNING: Invalidates any DataMapMutators/Readers that happen to be
-    //  pointing to any of this DataNode's children without any way of detecting
-    //  the invalidation.
+    // shifts the following children down by moving them; their own children
+    //  are not copied.
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
+    void DeleteChild (int index);
+
+    // moves the child at fromIndex so that it ends up at toIndex, shifting
+    //  those in between over by one.  Nothing is copied or reallocated, and
+    //  DataNodeHandles to the moved children keep working.
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
+    void MoveChild (int fromIndex, int toIndex);
+
+    // WARNING: Invalidates any raw pointers to this DataNode's children.
+    //  DataMapMutators/Readers pointing at them see the structure version
+    //  change and Revalidate() on their next use.
     // RETURNS: this.
     DataNode * DeleteAllChildren (void);
 };
@@ -0,0 +1,147 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cassert>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// A read-only cursor which is nothing but a node pointer.  Moving to a parent
+//  or sibling uses the node's own parent and index links, so there's no node
+//  stack to carry around, and copying a cursor costs one pointer.
+//
+// Unlike DataMapReader, once a move fails (no such child, no parent, ...) the
+//  cursor has nowhere to back out to.  Check GetChildByName() and friends on
+//  GetCurrentNode() first if a miss is expected.
+class DataNodeCursor {
+private:
+    // Data
+    const DataNode * m_node;
+
+public:
+    // Methods
+    explicit DataNodeCursor (const DataNode * node) : m_node(node) {}
+
+    inline const DataNode * GetCurrentNode (void) const { return m_node; }
+
+    inline bool IsValid (void) const                   { return m_node != nullptr; }
+
+    // RETURNS: -1 if invalidated, 0 if at a node with no parent, 1 if at one
+    //  of its children, and so on.
+    // NOTE: Walks up to the top of the tree.
+    inline int GetCurrentDepth (void) const {
+        int depth = -1;
+        for (const DataNode * node = m_node;  node;  node = node->GetParent())
+            ++depth;
+        return depth;
+    }
+
+    ///////
+    // navigation (begin)
+
+    // NOTE: If this is used on a node with no parent, the cursor becomes
+    //  invalidated.
+    inline DataNodeCursor & ToParent (void) {
+        assert(m_node && "DataNodeCursor::ToParent() called, but m_node == nullptr.");
+        m_node = m_node->GetParent();
+        return *this;
+    }
+
+    // if there are no children, the cursor becomes invalidated.
+    inline DataNodeCursor & ToFirstChild (void) {
+        assert(m_node && "DataNodeCursor::ToFirstChild() called, but m_node == nullptr.");
+        m_node = m_node->GetChildSafe(0);
+        return *this;
+    }
+
+    // if there are no children, the cursor becomes invalidated.
+    inline DataNodeCursor & ToLastChild (void) {
+        assert(m_node && "DataNodeCursor::ToLastChild() called, but m_node == nullptr.");
+        m_node = m_node->GetChildSafe(m_node->GetChildCount() - 1);
+        return *this;
+    }
+
+    // if there is no child at the given index, the cursor becomes invalidated.
+    inline DataNodeCursor & ToChild (int index) {
+        assert(m_node && "DataNodeCursor::ToChild(int index) called, but m_node == nullptr.");
+        m_node = m_node->GetChildSafe(index);
+        return *this;
+    }
+
+    // if no child with such a name exists, the cursor becomes invalidated.
+    inline DataNodeCursor & ToChild (const char * name) {
+        assert(m_node && "DataNodeCursor::ToChild(const char * name) called, but m_node == nullptr.");
+        m_node = m_node->GetChildByName(name);
+        return *this;
+    }
+
+    // same as above, but matches on the key's precomputed hash first.
+    inline DataNodeCursor & ToChild (const DataKey & key) {
+        assert(m_node && "DataNodeCursor::ToChild(const DataKey & key) called, but m_node == nullptr.");
+        m_node = m_node->GetChildByName(key);
+        return *this;
+    }
+
+    // if there is no next sibling, the cursor becomes invalidated.
+    inline DataNodeCursor & ToNextSibling (void) {
+        assert(m_node && "DataNodeCursor::ToNextSibling() called, but m_node == nullptr.");
+        m_node = m_node->GetNextSibling();
+        return *this;
+    }
+
+    // if there is no previous sibling, the cursor becomes invalidated.
+    inline DataNodeCursor & ToPreviousSibling (void) {
+        assert(m_node && "DataNodeCursor::ToPreviousSibling() called, but m_node == nullptr.");
+        m_node = m_node->GetPreviousSibling();
+        return *this;
+    }
+
+    // navigation (end)
+    ///////
+    // reading (begin)
+
+    inline const char * ReadName (void) const          { return m_node->GetName(); }
+    inline bool         ReadBool (void) const          { return m_node->GetBool(); }
+    inline int          ReadInt (void) const           { return m_node->GetInt(); }
+    inline float        ReadFloat (void) const         { return m_node->GetFloat(); }
+    inline const char * ReadString (void) const        { return m_node->GetString(); }
+
+    // RETURNS: true on success (and the out parameter is written to).
+    //          false otherwise, and the out parameter is not written to.
+    inline bool ReadBoolSafe (bool * outBool) const    { return m_node && m_node->QueryBool(outBool); }
+    inline bool ReadIntSafe (int * outInt) const       { return m_node && m_node->QueryInt(outInt); }
+    inline bool ReadFloatSafe (float * outFloat) const { return m_node && m_node->QueryFloat(outFloat); }
+    inline bool ReadStringSafe (char * outString, int bufferSizeInElements) const {
+        return m_node && m_node->QueryString(outString, bufferSizeInElements);
+    }
+
+    // reading (end)
+    ///////
+
+    inline bool operator== (const DataNodeCursor & rhs) const { return m_node == rhs.m_node; }
+    inline bool operator!= (const DataNodeCursor & rhs) const { return m_node != rhs.m_node; }
+
+    DataNodeCursor (void) = delete;
+};
+
+} // namespace CSaruDataMap
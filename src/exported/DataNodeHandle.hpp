@@ -0,0 +1,122 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace CSaruDataMap {
+
+class DataNode;
+class DataNodeHandle;
+
+// Process-wide table of node slots backing DataNodeHandles.  Slots live in
+//  fixed-size blocks which are never moved or freed, so a slot can be found
+//  with two loads no matter how large the table grows.
+//
+// DataNodes keep their slot's pointer up to date as they are moved around
+//  inside their parent's m_children, and release the slot (bumping its
+//  generation) when destroyed.
+//
+// The table holds at most s_maxBlocks * s_blockSize (16M) slots at once;
+//  Acquire() aborts the process if they're all taken.
+//
+// Entries are atomic, so resolving a handle on one thread while another moves
+//  or destroys nodes is not a data race on the table.  It says nothing about
+//  the node itself, though: a node Resolve()d on one thread can be moved or
+//  destroyed by another right after.  Handles into one tree must not be used
+//  across threads without the same external locking the tree itself needs.
+class DataNodeHandleTable {
+public:
+    // Type and Constants
+    static const unsigned s_blockBits = 12;
+    static const unsigned s_blockSize = 1u << s_blockBits;
+    static const unsigned s_maxBlocks = 4096;
+
+    struct Entry {
+        std::atomic<DataNode *>    m_node;
+        std::atomic<std::uint32_t> m_generation;
+        std::uint32_t              m_nextFree;   // guarded by the table's mutex
+    };
+
+private:
+    // Data
+    static std::atomic<Entry *> s_blocks[s_maxBlocks];
+
+public:
+    // Methods
+    static inline Entry & GetEntry (std::uint32_t slot) {
+        return s_blocks[slot >> s_blockBits].load(std::memory_order_acquire)[slot & (s_blockSize - 1)];
+    }
+
+    // RETURNS: a new slot pointing at node.  Never returns 0.
+    // WARNING: Aborts if every slot is already in use.
+    static std::uint32_t Acquire (DataNode * node);
+
+    // invalidates every handle to the slot, and makes it available for reuse.
+    static void Release (std::uint32_t slot);
+
+    static inline void Relocate (std::uint32_t slot, DataNode * node) {
+        GetEntry(slot).m_node.store(node, std::memory_order_relaxed);
+    }
+
+    static inline DataNode * Resolve (std::uint32_t slot, std::uint32_t generation) {
+        if (slot == 0)
+            return nullptr;
+        const Entry & entry = GetEntry(slot);
+        return entry.m_generation.load(std::memory_order_acquire) == generation ? entry.m_node.load(std::memory_order_relaxed) : nullptr;
+    }
+
+    DataNodeHandleTable (void) = delete;
+};
+
+// Names a DataNode in a way that survives the node being moved around by
+//  insertions into (or reallocation of) its parent's m_children.  Resolving a
+//  handle is O(1), and a handle to a node which has since been destroyed
+//  resolves to nullptr instead of dangling.
+//
+// NOTE: Copying a DataNode does not copy its handle; the copy is a different
+//  node.  Overwriting a node through assignment from a temporary (as
+//  std::vector does when shifting children) hands the temporary's handle over.
+class DataNodeHandle {
+public:
+    // Data
+    std::uint32_t m_slot;       // 0 for the null handle
+    std::uint32_t m_generation;
+
+public:
+    // Methods
+    DataNodeHandle (void) : m_slot(0), m_generation(0) {}
+    DataNodeHandle (std::uint32_t slot, std::uint32_t generation) : m_slot(slot), m_generation(generation) {}
+
+    inline bool IsNull (void) const                    { return m_slot == 0; }
+
+    // RETURNS: nullptr if this is the null handle, or its node was destroyed.
+    inline DataNode * Resolve (void) const             { return DataNodeHandleTable::Resolve(m_slot, m_generation); }
+
+    // RETURNS: true if the node this handle was taken from still exists.
+    inline bool IsAlive (void) const                   { return Resolve() != nullptr; }
+
+    inline bool operator== (const DataNodeHandle & rhs) const { return m_slot == rhs.m_slot && m_generation == rhs.m_generation; }
+    inline bool operator!= (const DataNodeHandle & rhs) const { return !(*this == rhs); }
+};
+
+} // namespace CSaruDataMap
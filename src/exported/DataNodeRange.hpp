@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Ranges over DataNodes for range-for and the standard algorithms.
+//
+//  Children(node)      a node's children.  Its iterators are plain pointers,
+//                      so it works with the C++17 parallel algorithms:
+//                          std::for_each(std::execution::par,
+//                              Children(array).begin(), Children(array).end(), f);
+//  DepthFirst(node)    node and all its descendants, pre-order.  Stackless;
+//                      follows parent links, so no allocation at all.
+//  BreadthFirst(node)  node and all its descendants, level by level.  The
+//                      range lists them all when it's made (a pointer per
+//                      node), so its iterators can be copied and shared, as
+//                      the parallel algorithms do.
+//
+// WARNING: Like raw node pointers, these go bad if the structure of the map
+//  changes while they're in use.
+
+//=========================================================================
+template <typename Node>
+class DataNodeChildRange {
+private:
+    // Data
+    Node * m_begin;
+    Node * m_end;
+
+public:
+    // Type and Constants
+    typedef Node *      iterator;
+    typedef Node &      reference;
+    typedef std::size_t size_type;
+
+    // Methods
+    DataNodeChildRange (Node * begin, Node * end) : m_begin(begin), m_end(end) {}
+
+    inline Node * begin (void) const                   { return m_begin; }
+    inline Node * end (void) const                     { return m_end; }
+    inline std::size_t size (void) const               { return std::size_t(m_end - m_begin); }
+    inline bool empty (void) const                     { return m_begin == m_end; }
+    inline Node & operator[] (std::size_t index) const { return m_begin[index]; }
+};
+
+//=========================================================================
+template <typename Node>
+class DataNodeDepthFirstIterator {
+private:
+    // Data
+    Node * m_node;
+    Node * m_root;
+
+public:
+    // Type and Constants
+    typedef std::forward_iterator_tag iterator_category;
+    typedef DataNode                  value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef Node *                    pointer;
+    typedef Node &                    reference;
+
+    // Methods
+    DataNodeDepthFirstIterator (void) : m_node(nullptr), m_root(nullptr) {}
+    DataNodeDepthFirstIterator (Node * node, Node * root) : m_node(node), m_root(root) {}
+
+    inline Node & operator* (void) const               { return *m_node; }
+    inline Node * operator-> (void) const              { return m_node; }
+
+    inline DataNodeDepthFirstIterator & operator++ (void) {
+        if (m_node->HasChildren()) {
+            m_node = m_node->GetChildFast(0);
+            return *this;
+        }
+        while (m_node != m_root) {
+            Node * next = m_node->GetNextSibling();
+            if (next) {
+                m_node = next;
+                return *this;
+            }
+            m_node = m_node->GetParent();
+        }
+        m_node = nullptr;
+        return *this;
+    }
+
+    inline DataNodeDepthFirstIterator operator++ (int) {
+        DataNodeDepthFirstIterator result(*this);
+        ++*this;
+        return result;
+    }
+
+    inline bool operator== (const DataNodeDepthFirstIterator & rhs) const { return m_node == rhs.m_node; }
+    inline bool operator!= (const DataNodeDepthFirstIterator & rhs) const { return m_node != rhs.m_node; }
+};
+
+//=========================================================================
+template <typename Node>
+class DataNodeDepthFirstRange {
+private:
+    // Data
+    Node * m_root;
+
+public:
+    // Type and Constants
+    typedef DataNodeDepthFirstIterator<Node> iterator;
+
+    // Methods
+    explicit DataNodeDepthFirstRange (Node * root) : m_root(root) {}
+
+    inline iterator begin (void) const                 { return iterator(m_root, m_root); }
+    inline iterator end (void) const                   { return iterator(nullptr, m_root); }
+};
+
+//=========================================================================
+template <typename Node>
+class DataNodeBreadthFirstIterator {
+private:
+    // Data
+    Node * const * m_at;
+
+public:
+    // Type and Constants
+    typedef std::forward_iterator_tag iterator_category;
+    typedef DataNode                  value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef Node *                    pointer;
+    typedef Node &                    reference;
+
+    // Methods
+    DataNodeBreadthFirstIterator (void) : m_at(nullptr) {}
+    explicit DataNodeBreadthFirstIterator (Node * const * at) : m_at(at) {}
+
+    inline Node & operator* (void) const               { return **m_at; }
+    inline Node * operator-> (void) const              { return *m_at; }
+
+    inline DataNodeBreadthFirstIterator & operator++ (void) {
+        ++m_at;
+        return *this;
+    }
+
+    inline DataNodeBreadthFirstIterator operator++ (int) {
+        DataNodeBreadthFirstIterator result(*this);
+        ++m_at;
+        return result;
+    }
+
+    inline bool operator== (const DataNodeBreadthFirstIterator & rhs) const { return m_at == rhs.m_at; }
+    inline bool operator!= (const DataNodeBreadthFirstIterator & rhs) const { return m_at != rhs.m_at; }
+};
+
+//=========================================================================
+template <typename Node>
+class DataNodeBreadthFirstRange {
+private:
+    // Data
+    std::vector<Node *> m_order;
+
+public:
+    // Type and Constants
+    typedef DataNodeBreadthFirstIterator<Node> iterator;
+
+    // Methods
+    explicit DataNodeBreadthFirstRange (Node * root) {
+        if (root == nullptr)
+            return;
+        // the list itself is the queue: each node's children go on the end
+        //  as it's reached.
+        m_order.push_back(root);
+        for (std::size_t i = 0;  i < m_order.size();  ++i) {
+            Node *    parent     = m_order[i];
+            const int childCount = parent->GetChildCount();
+            for (int c = 0;  c < childCount;  ++c)
+                m_order.push_back(parent->GetChildFast(c));
+        }
+    }
+
+    inline iterator begin (void) const                 { return iterator(m_order.data()); }
+    inline iterator end (void) const                   { return iterator(m_order.data() + m_order.size()); }
+    inline std::size_t size (void) const               { return m_order.size(); }
+};
+
+//=========================================================================
+inline DataNodeChildRange<DataNode> Children (DataNode & node) {
+    DataNode * first = node.m_children.data();
+    return DataNodeChildRange<DataNode>(first, first + node.m_children.size());
+}
+
+inline DataNodeChildRange<const DataNode> Children (const DataNode & node) {
+    const DataNode * first = node.m_children.data();
+    return DataNodeChildRange<const DataNode>(first, first + node.m_children.size());
+}
+
+inline DataNodeDepthFirstRange<DataNode> DepthFirst (DataNode & node) {
+    return DataNodeDepthFirstRange<DataNode>(&node);
+}
+
+inline DataNodeDepthFirstRange<const DataNode> DepthFirst (const DataNode & node) {
+    return DataNodeDepthFirstRange<const DataNode>(&node);
+}
+
+inline DataNodeBreadthFirstRange<DataNode> BreadthFirst (DataNode & node) {
+    return DataNodeBreadthFirstRange<DataNode>(&node);
+}
+
+inline DataNodeBreadthFirstRange<const DataNode> BreadthFirst (const DataNode & node) {
+    return DataNodeBreadthFirstRange<const DataNode>(&node);
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// The edits which turn one DataMap into another, for sending a map's changes
+//  somewhere that already has the old version:
+//
+//      patch.Diff(lastSent, current);
+//      ...
+//      patch.Apply(&remoteCopy);
+//
+// Diff() skips every subtree whose GetSubtreeHash() matches, so unchanged
+//  regions cost one compare each.  Object children are matched up by name and
+//  Array children by content, so an element inserted at the front of an Array
+//  is one Add rather than a Replace of everything after it.  Children which
+//  only changed places become Moves, as few as possible.  Where patching a
+//  container's children would take more edits than it has children, the
+//  whole container is Replaced instead.
+//
+// Every op names its node by child indices from the root.  Ops are in the
+//  order they must be applied; for each container, its Removes come first,
+//  then Moves, then Adds, then the ops inside its children (which use the
+//  children's final indices).
+class DataPatch {
+public:
+    // Type and Constants
+    struct Op {
+        enum class Kind {
+            Add,        // insert a copy of the value at the path
+            Remove,     // delete the node at the path
+            Replace,    // overwrite the node at the path with the value, keeping its name
+            Move        // move the node at the path to m_toIndex under the same parent
+        };
+
+        Kind m_kind;
+        int  m_pathBegin;   // into the patch's path indices
+        int  m_pathLength;  // 0 for the root (only ever Replaced)
+        int  m_toIndex;     // Move only
+        int  m_value;       // Add and Replace only; into the patch's values
+    };
+
+    static const char * GetKindName (Op::Kind kind);
+
+private:
+    // Data
+    std::vector<Op>       m_ops;
+    std::vector<int>      m_pathIndices;    // every op's path, back to back
+    std::vector<DataNode> m_values;
+
+    // diffing scratch, kept between Diff()s so they don't reallocate
+    std::vector<int>      m_path;
+
+    // Helpers
+    void AddOp (Op::Kind kind, int lastIndex, int toIndex, const DataNode * value);
+    void DiffNode (const DataNode & from, const DataNode & to);
+    void DiffChildren (const DataNode & from, const DataNode & to);
+
+public:
+    // Methods
+    DataPatch (void) {}
+
+    // empties the patch, keeping its memory for reuse.
+    void Clear (void);
+
+    // replaces the contents of this patch with the edits which turn from into
+    //  to.  The roots' own names are ignored.
+    void Diff (const DataNode & from, const DataNode & to);
+
+    // runs every op through a DataMapMutator started at root.
+    // RETURNS: false if the patch doesn't fit root (some path leads nowhere).
+    //  The ops before the bad one will have been applied.
+    bool Apply (DataNode * root) const;
+
+    inline bool IsEmpty (void) const                     { return m_ops.empty(); }
+    inline int GetOpCount (void) const                   { return int(m_ops.size()); }
+    inline const Op & GetOp (int index) const            { return m_ops[index]; }
+    inline const int * GetPath (const Op & op) const     { return m_pathIndices.data() + op.m_pathBegin; }
+    inline const DataNode * GetValue (const Op & op) const {
+        return op.m_value < 0 ? nullptr : &m_values[op.m_value];
+    }
+};
+
+} // namespace CSaruDataMap
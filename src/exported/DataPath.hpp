@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// A path through a DataMap, compiled once from a string like "a.b[3].c".
+//  Names are separated by '.', and child indices are given in brackets.
+//
+// Resolving a path against a node remembers the child indices it took along
+//  with the node's handle and structure version.  Resolving again from the
+//  same node while its structure is unchanged costs a couple of compares;
+//  after a change, the path is walked again by name.  The node is known by
+//  its handle rather than its address, so a new node which happens to be
+//  made where a destroyed one was is never mistaken for it.
+//
+// NOTE: Renaming a node does not change any structure version, so a path
+//  which was resolved before a rename will keep finding the renamed node
+//  until something else invalidates it.
+// NOTE: Resolving updates the cache, so one DataPath must not be resolved
+//  from several threads at once.
+class DataPath {
+public:
+    // Type and Constants
+    struct Step {
+        int  m_index;                       // -1 if this step is by name
+        char m_name[DataNode::s_nameSize];
+    };
+
+private:
+    // Data
+    std::vector<Step>        m_steps;
+    bool                     m_valid;
+
+    // resolution cache
+    mutable DataNodeHandle   m_cachedBase;
+    mutable std::uint32_t    m_cachedVersion;
+    mutable const DataNode * m_cachedNode;
+    mutable std::vector<int> m_cachedIndices;
+
+public:
+    // Methods
+    DataPath (void);
+
+    // if path can't be parsed, IsValid() will be false and the path will have
+    //  no steps.
+    explicit DataPath (const char * path);
+
+    bool Compile (const char * path);
+
+    inline bool IsValid (void) const                   { return m_valid; }
+    inline int GetStepCount (void) const               { return int(m_steps.size()); }
+    inline const Step & GetStep (int index) const      { return m_steps[index]; }
+
+    // RETURNS: the node at the end of the path, starting from base.  nullptr
+    //  if some step along the way doesn't exist, or the path isn't valid.
+    // NOTE: Gives base a handle (see DataNode::GetHandle()) if it has none.
+    const DataNode * Resolve (const DataNode * base) const;
+    inline DataNode * Resolve (DataNode * base) const {
+        return const_cast<DataNode *>(Resolve(static_cast<const DataNode *>(base)));
+    }
+
+    // RETURNS: the child index taken at each step of the last Resolve().  If
+    //  it failed, holds only the steps which were found.
+    inline const std::vector<int> & GetResolvedIndices (void) const { return m_cachedIndices; }
+
+    // forgets the cached resolution.
+    void Invalidate (void) const;
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// Expected types, required keys, and ranges for a DataMap.  Rules are built
+//  up in C++ (or loaded from a DataNode), then compiled into a flat program:
+//  each rule's fields sit next to each other sorted by name hash, so
+//  validation is one walk over the map with no allocation per node.
+//
+// Ranges apply to the value of Int and Float nodes, the length of String
+//  nodes, and the child count of Object and Array nodes.
+//
+// Once a map validates, the unchecked accessors (GetInt(), GetChildFast(),
+//  and so on) can be used on the parts the schema covers.
+class DataSchema {
+public:
+    // Type and Constants
+    static inline std::uint32_t TypeBit (DataNode::Type type) { return 1u << unsigned(type); }
+
+    static const std::uint32_t s_anyType = ~0u;
+
+    struct Violation {
+        enum class Kind {
+            WrongType,      // the node's type isn't one the rule allows
+            MissingKey,     // a required field isn't there
+            UnexpectedKey,  // a child not named by any field, and unknown keys aren't allowed
+            OutOfRange      // value, length, or child count outside the rule's range
+        };
+
+        Kind        m_kind;
+        std::string m_path;     // like "a.b[3].c"; empty for the root
+    };
+
+    static const char * GetKindName (Violation::Kind kind);
+
+private:
+    static const std::uint8_t s_flagRequired     = 1 << 0;
+    static const std::uint8_t s_flagAllowUnknown = 1 << 1;
+    static const std::uint8_t s_flagHasMin       = 1 << 2;
+    static const std::uint8_t s_flagHasMax       = 1 << 3;
+
+    struct Rule {
+        char          m_name[DataNode::s_nameSize];
+        std::uint32_t m_nameHash;
+        std::uint32_t m_typeMask;
+        std::uint8_t  m_flags;
+        double        m_min;
+        double        m_max;
+        int           m_firstField;     // compiled: index of first field rule
+        int           m_fieldCount;
+        int           m_elements;       // rule for every child; -1 if none
+    };
+
+    // Data
+    std::vector<Rule>               m_rules;        // as built; rule 0 is the root
+    std::vector<std::vector<int>>   m_ruleFields;   // as built; field rules of each rule
+    std::vector<Rule>               m_program;      // compiled
+    bool                            m_compiled;
+
+    // Helpers
+    bool ValidateNode (
+        int                      ruleIndex,
+        const DataNode &         node,
+        std::string *            path,
+        std::vector<Violation> * outViolations
+    ) const;
+    bool LoadRule (int ruleIndex, const DataNode & ruleNode);
+    int AddRule (const char * name);
+
+public:
+    // Methods
+    // starts with a root rule which allows any type.
+    DataSchema (void);
+
+    // forgets every rule except the root, which goes back to allowing anything.
+    void Clear (void);
+
+    inline int GetRootRule (void) const { return 0; }
+
+    void SetTypes (int rule, std::uint32_t typeMask);
+
+    // RETURNS: the new field's rule.
+    int AddField (int objectRule, const char * name, std::uint32_t typeMask, bool required = true);
+
+    // RETURNS: the rule every child of arrayRule must satisfy.  Created on the
+    //  first call; later calls update and return the same rule.
+    int SetElements (int arrayRule, std::uint32_t typeMask);
+
+    void SetRange (int rule, double min, double max);
+    void SetMin (int rule, double min);
+    void SetMax (int rule, double max);
+
+    // unknown keys are allowed by default.
+    void SetAllowUnknownKeys (int rule, bool allow);
+
+    // Replaces every rule with those described by schemaNode:
+    //  type:         "null", "object", "array", "bool", "int", "float",
+    //                "number", "string", or "any"; or an Array of those
+    //  required:     Bool, default true (only meaningful on fields)
+    //  min, max:     Int or Float
+    //  allowUnknown: Bool, default true
+    //  fields:       Object of name -> rule
+    //  elements:     rule
+    // RETURNS: false if schemaNode isn't well formed.  The schema is then left
+    //  with only a root rule.
+    bool LoadFromNode (const DataNode & schemaNode);
+
+    // must be called after the last change and before Validate().
+    void Compile (void);
+
+    inline bool IsCompiled (void) const { return m_compiled; }
+
+    // checks node against the compiled rules.  If outViolations is given,
+    //  every violation is appended to it; otherwise validation stops at the
+    //  first.
+    // RETURNS: true if node satisfies the schema.
+    bool Validate (const DataNode & node, std::vector<Violation> * outViolations = nullptr) const;
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,328 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+#include "OffsetDataMapReader.hpp"
+#include "OffsetDataNode.hpp"
+
+namespace CSaruDataMap {
+
+class DataKey;
+class MappedDataMapMutator;
+
+// A DataMap kept in a memory-mapped file, and edited there in place.  There's
+//  nothing to load: opening one maps the file, and the OS pages parts of it
+//  in as they're read and out again when memory is tight.
+//
+//      MappedDataMap map;
+//      map.Open("state.mdm");              // made if it doesn't exist
+//      MappedDataMapMutator mutator = map.GetMutator();
+//      mutator.ToChild("hits").Write(mutator.ReadInt() + 1);
+//      map.Sync();
+//
+// The file is one array of OffsetDataNode-sized slots.  Nodes are read with
+//  an OffsetDataMapReader straight off the mapping: node indices are slot
+//  indices, and names and strings are byte offsets from the start of the
+//  file.  Children, names and strings each take a power-of-two block of
+//  slots from a free list per size, so a file's 4 GiB limit is that of its
+//  32-bit offsets.  When no block is free, the file is doubled and remapped.
+//
+// Sync() is the only flush.  A file that wasn't Sync()ed or Close()d is
+//  checked when it's opened again; if its tree is whole, its free lists are
+//  rebuilt from it, and changes made since the last Sync() may or may not be
+//  in it.
+//
+// NOTE: POSIX only.  Elsewhere, Open() fails.
+// WARNING: Growing the file moves the mapping.  Node pointers, Readers, and
+//  strings read before any change may be left pointing at the old one.
+class MappedDataMap {
+public:
+    // Type and Constants
+    static const std::uint32_t s_noNode     = 0xFFFFFFFF;
+    static const std::uint32_t s_slotSize   = sizeof(OffsetDataNode);
+
+private:
+    // Types
+    // in the first slots of the file.
+    struct Header {
+        std::uint32_t m_magic;
+        std::uint32_t m_slotCount;      // the whole file
+        std::uint32_t m_nextSlot;       // slots from here on have never been used
+        std::uint32_t m_root;
+        std::uint32_t m_dirty;          // cleared only by Sync()
+        std::uint32_t m_freeLists[28];  // first free block of 1 << i slots, or 0
+        char          m_empty[4];       // "", for every empty name and string
+    };
+
+    // Type and Constants
+    static const std::uint32_t s_magic        = 0x314D444D;  // "MDM1", little-endian
+    static const std::uint32_t s_classCount   = sizeof(Header::m_freeLists) / sizeof(std::uint32_t);
+    static const std::uint32_t s_headerSlots  = (sizeof(Header) + s_slotSize - 1) / s_slotSize;
+    static const std::uint32_t s_initialSlots = 1024;
+    static const std::uint32_t s_maxSlots     = 0xFFFFFFFF / s_slotSize;
+
+    // Data
+    std::string    m_path;
+    int            m_file;
+    std::uint8_t * m_base;
+    std::size_t    m_size;
+    bool           m_failed;    // a change couldn't be made, for lack of space
+
+    // Helpers
+    inline Header * GetHeader (void) const             { return reinterpret_cast<Header *>(m_base); }
+    inline OffsetDataNode * GetNodes (void) const      { return reinterpret_cast<OffsetDataNode *>(m_base); }
+    inline std::uint32_t GetEmptyString (void) const   { return std::uint32_t(offsetof(Header, m_empty)); }
+
+    bool Map (std::size_t size);
+    void Unmap (void);
+    bool Grow (std::uint32_t minSlots);
+    // checks the tree of a file which wasn't synced, and rebuilds the free
+    //  lists from what it uses.
+    // RETURNS: false if the tree isn't whole.
+    bool Recover (void);
+
+    // RETURNS: the first of a block of at least slots slots, or 0 if the file
+    //  can't grow.
+    // WARNING: May remap the file.
+    std::uint32_t Allocate (std::uint32_t slots);
+    void Free (std::uint32_t block, std::uint32_t slots);
+
+    // RETURNS: str's offset, truncated to maxLength chars, or 0 if there's no
+    //  room for it.
+    // WARNING: May remap the file.
+    std::uint32_t AllocateString (const char * str, std::size_t length, std::size_t maxLength);
+    void FreeString (std::uint32_t offset);
+
+    // frees node's string, and its children and everything under them.
+    //  node keeps its name and type, with no children.
+    void FreeValue (std::uint32_t node);
+    // FreeValue()s, then makes node type.
+    void ResetValue (std::uint32_t node, DataNode::Type type);
+
+    // these return false, leaving node untouched, if there's no room.
+    bool SetName (std::uint32_t node, const char * name, std::size_t length);
+    bool SetString (std::uint32_t node, const char * str, std::size_t length);
+    // replaces node's value and children with source's.  Keeps node's name.
+    // RETURNS: false if there's no room, with node left holding part of
+    //  source.
+    bool SetSubtree (std::uint32_t node, const DataNode & source);
+
+    // a node which isn't a container becomes an Object.
+    // RETURNS: the new Unused child, or s_noNode if there's no room.
+    std::uint32_t InsertChild (std::uint32_t parent, std::uint32_t index);
+    void DeleteChild (std::uint32_t parent, std::uint32_t index);
+    void MoveChild (std::uint32_t parent, std::uint32_t fromIndex, std::uint32_t toIndex);
+    std::uint32_t FindChild (std::uint32_t parent, const DataKey & key) const;
+
+    // marks the file as not synced, before the first change since the last
+    //  Sync() goes in.
+    void Touch (void);
+
+    friend class MappedDataMapMutator;
+
+public:
+    // Methods
+    MappedDataMap (void);
+    // Close()s.
+    ~MappedDataMap ();
+
+    // maps the file at path, making it if it doesn't exist (with an empty
+    //  Object at the root).
+    // RETURNS: false if the file can't be made or mapped, isn't a
+    //  MappedDataMap, or wasn't synced and is broken.
+    bool Open (const char * path);
+
+    // Sync()s and unmaps.
+    // RETURNS: what Sync() did.
+    bool Close (void);
+
+    inline bool IsOpen (void) const                    { return m_base != nullptr; }
+    inline std::size_t GetFileSize (void) const        { return m_size; }
+
+    // RETURNS: true if a change was dropped since Open(), for lack of space.
+    inline bool HasFailed (void) const                 { return m_failed; }
+
+    // writes every change to the file, and marks it as whole.
+    // RETURNS: false if the OS couldn't, or HasFailed().
+    bool Sync (void);
+
+    // the whole file, seen as an OffsetDataNode image.
+    inline std::uint32_t GetRootIndex (void) const     { return GetHeader()->m_root; }
+    inline const OffsetDataNode * GetNode (std::uint32_t index) const { return GetNodes() + index; }
+    inline const char * GetString (std::uint32_t offset) const { return reinterpret_cast<const char *>(m_base) + offset; }
+
+    // RETURNS: a Reader at the root.
+    OffsetDataMapReader GetReader (void) const;
+
+    // RETURNS: a Mutator at the root.
+    MappedDataMapMutator GetMutator (void);
+
+    // replaces everything in the map with a copy of root.
+    // RETURNS: false if there's no room (the map is then left empty).
+    bool CopyFrom (const DataNode & root);
+
+    void CopyTo (DataNode * outRoot) const;
+
+    DISALLOW_COPY_AND_ASSIGN(MappedDataMap)
+};
+
+// Navigates and edits a MappedDataMap with a DataMapMutator's calls, and the
+//  same habit of making whatever it's sent to that isn't there yet.  The
+//  cursor is a node index plus a stack of them, so it survives the file
+//  being remapped.
+//
+// Names and strings are cut short to what a DataNode holds.  Any change
+//  which needs more space than the file can grow to is dropped, and the map
+//  HasFailed(): writes return false, and steps to a child that can't be made
+//  leave the Mutator invalid.  The map itself stays as it was, and usable.
+//
+// WARNING: Adding or deleting children moves their siblings' slots.  Other
+//  Mutators and Readers below a node whose children change go bad, as raw
+//  node pointers do in a DataNode tree.
+class MappedDataMapMutator {
+private:
+    // Data
+    MappedDataMap *            m_map;
+    std::uint32_t              m_node;
+    std::vector<std::uint32_t> m_nodeStack;     // does *not* contain m_node.
+
+    // Helpers
+    inline OffsetDataNode & GetNode (void) const       { return m_map->GetNodes()[m_node]; }
+    void PushNode (std::uint32_t node);
+
+public:
+    // Methods
+    explicit MappedDataMapMutator (MappedDataMap * map);
+
+    inline const OffsetDataNode * GetCurrentNode (void) const { return m_node == MappedDataMap::s_noNode ? nullptr : &GetNode(); }
+
+    // RETURNS: -1 if invalidated, 0 if at the root node, 1 if at one of the root
+    //  node's children, and so on.
+    inline int GetCurrentDepth (void) const            { return int(m_nodeStack.size()) - (m_node == MappedDataMap::s_noNode ? 1 : 0); }
+
+    inline bool IsValid (void) const                   { return m_node != MappedDataMap::s_noNode; }
+
+    inline int GetChildCount (void) const              { return IsValid() ? int(GetNode().m_childCount) : 0; }
+
+    ///////
+    // navigation (begin)
+
+    // return to the parent node.
+    // NOTE: If this is used on the root node, the Mutator becomes invalidated.
+    MappedDataMapMutator & PopNode (void);
+
+    // this is a mutator.  If there are no children, one is made.
+    MappedDataMapMutator & ToFirstChild (void);
+    MappedDataMapMutator & ToLastChild (void);
+
+    // this is a mutator.  If there are not enough children, they are made.
+    MappedDataMapMutator & ToChild (int index);
+
+    // this is a mutator.  If there is no such child, one is made.
+    MappedDataMapMutator & ToChild (const char * name);
+    MappedDataMapMutator & ToChild (const DataKey & key);
+
+    // same as PopNode(), then ToChild(index + 1), but without touching the
+    //  node stack.
+    MappedDataMapMutator & ToNextSibling (void);
+
+    // same as PopNode(), then ToChild(index - 1), but without touching the
+    //  node stack.  If this is the first child, a new one is inserted before
+    //  it.
+    MappedDataMapMutator & ToPreviousSibling (void);
+
+    // navigation (end)
+    ///////
+    // writing (begin)
+
+    // a container keeps its children.
+    MappedDataMapMutator & SetToObjectType (void);
+    MappedDataMapMutator & SetToArrayType (void);
+    // deletes any children.
+    MappedDataMapMutator & SetToNullType (void);
+
+    // RETURNS: false if the file couldn't grow to fit the change, which was
+    //  then dropped (see HasFailed()).  With a name, the value is still
+    //  written when only the name doesn't fit, and the other way around.
+    bool WriteName (const char * name);
+
+    bool Write (                   bool boolValue);
+    bool Write (const char * name, bool boolValue);
+    bool Write (                   int intValue);
+    bool Write (const char * name, int intValue);
+    bool Write (                   float floatValue);
+    bool Write (const char * name, float floatValue);
+    bool Write (                   const char * stringValue);
+    bool Write (const char * name, const char * stringValue);
+
+    // Deletes this node's last ((count)) children.
+    void DeleteLastChildren (int count);
+
+    // inserts a Null child at index, and stays on the current node.
+    MappedDataMapMutator & InsertChild (int index);
+
+    void DeleteChild (int index);
+
+    // see DataNode::MoveChild().
+    void MoveChild (int fromIndex, int toIndex);
+
+    // replaces the current node's value and children with a copy of value's.
+    //  Keeps the current node's name.
+    // RETURNS: false if there's no room, with the node left holding part of
+    //  value.
+    bool WriteNode (const DataNode & value);
+
+    // writing (end)
+    ///////
+    // reading (begin)
+
+    // WARNING: The strings these return are in the mapping; see
+    //  MappedDataMap.
+    const char * ReadName (void) const;
+    bool         ReadBool (void) const;
+    int          ReadInt (void) const;
+    float        ReadFloat (void) const;
+    const char * ReadString (void) const;
+
+    // RETURNS: true on success (and the out parameter is written to).
+    //          false otherwise, and the out parameter is not written to.
+    bool ReadBoolSafe (bool * outBool) const;
+    bool ReadIntSafe (int * outInt) const;
+    bool ReadFloatSafe (float * outFloat) const;
+    bool ReadStringSafe (char * outString, int bufferSizeInElements) const;
+
+    // reading (end)
+    ///////
+
+    MappedDataMapMutator (void) = delete;
+};
+
+} // namespace CSaruDataMap
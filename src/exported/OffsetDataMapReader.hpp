@@ -0,0 +1,196 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "OffsetDataNode.hpp"
+
+namespace CSaruDataMap {
+
+class DataKey;
+
+// Walks an OffsetDataNode image the way a DataMapReader walks DataNodes, with
+//  the same navigation and reading calls.  The cursor is a node index plus a
+//  stack of them, so the image can sit at a different address in every
+//  process that reads it.
+//
+// Every index and offset is range-checked as it's followed, so a reader over
+//  an image that's being overwritten (see SharedDataMap) reads wrong values
+//  at worst, and never outside the image.  Such a reader is given the
+//  writer's sequence; IsStale() says whether what it has read so far can be
+//  trusted.
+class OffsetDataMapReader {
+private:
+    // Type and Constants
+    static const std::uint32_t s_noNode = 0xFFFFFFFF;
+
+    // Data
+    const OffsetDataNode *             m_nodes;
+    std::uint32_t                      m_nodeCount;
+    const char *                       m_strings;
+    std::uint32_t                      m_stringBytes;
+    std::uint32_t                      m_node;
+    std::vector<std::uint32_t>         m_nodeStack;
+
+    // seqlock sequence of the writer, if any, and its value when this
+    //  Reader was made.
+    const std::atomic<std::uint64_t> * m_sequence;
+    std::uint64_t                      m_startSequence;
+
+    // Helpers
+    void PushNode (std::uint32_t node);
+    std::uint32_t FindChild (const DataKey & key) const;
+    // RETURNS: "" if offset is out of range.
+    const char * GetString (std::uint32_t offset) const;
+
+public:
+    // Methods
+    // starts at the node at index root.
+    // NOTE: strings must be null-terminated somewhere before the readable
+    //  memory ends, even if stringBytes cuts a string short.
+    OffsetDataMapReader (
+        const OffsetDataNode * nodes,
+        std::uint32_t          nodeCount,
+        const char *           strings,
+        std::uint32_t          stringBytes,
+        std::uint32_t          root = 0
+    );
+
+    // reads a Validate()d image.
+    explicit OffsetDataMapReader (const void * image);
+
+    // the same, but the image may be overwritten by a writer which bumps
+    //  *sequence as a seqlock: odd while it writes, even once done.  See
+    //  SharedDataMap.
+    OffsetDataMapReader (
+        const OffsetDataNode *             nodes,
+        std::uint32_t                      nodeCount,
+        const char *                       strings,
+        std::uint32_t                      stringBytes,
+        const std::atomic<std::uint64_t> * sequence,
+        std::uint64_t                      startSequence
+    );
+
+    inline const OffsetDataNode * GetCurrentNode (void) const { return m_node == s_noNode ? nullptr : &m_nodes[m_node]; }
+
+    // RETURNS: -1 if invalidated, 0 if at the root node, 1 if at one of the root
+    //  node's children, and so on.
+    inline int GetCurrentDepth (void) const            { return int(m_nodeStack.size()) - (m_node == s_noNode ? 1 : 0); }
+
+    inline bool IsValid (void) const                   { return m_node != s_noNode; }
+
+    inline int GetChildCount (void) const              { return IsValid() ? int(m_nodes[m_node].m_childCount) : 0; }
+
+    // RETURNS: true if the image may have been overwritten since this Reader
+    //  was made, meaning anything read from it may be wrong.  Always false
+    //  without a writer's sequence.
+    // NOTE: Check this *after* reading.  Copy strings out (ReadStringSafe())
+    //  before checking, since the image may change under them after.
+    bool IsStale (void) const;
+
+    ///////
+    // navigation (begin)
+
+    // return to the parent node.
+    // NOTE: If this is used on the root node, the Reader becomes invalidated.
+    OffsetDataMapReader & PopNode (void);
+
+    // if there are no children, the current node will become null.  You must
+    //  PopNode to back out of this state.
+    OffsetDataMapReader & ToFirstChild (void);
+
+    // if there are no children, the current node will become null.  You must
+    //  PopNode to back out of this state.
+    OffsetDataMapReader & ToLastChild (void);
+
+    // if there is no child at the given index, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    OffsetDataMapReader & ToChild (int index);
+
+    // if no child with such a name exists, the current node will become
+    //  null.  You must PopNode to back out of this state.
+    OffsetDataMapReader & ToChild (const char * name);
+
+    // same as above, but matches on the key's precomputed hash first.
+    OffsetDataMapReader & ToChild (const DataKey & key);
+
+    // same as PopNode(), then ToChild(index + 1), but without touching the
+    //  node stack.
+    // NOTE: If this is used on the root node, the Reader becomes invalidated.
+    OffsetDataMapReader & ToNextSibling (void);
+
+    // same as PopNode(), then ToChild(index - 1), but without touching the
+    //  node stack.
+    // NOTE: If this is used on the root node, the Reader becomes invalidated.
+    OffsetDataMapReader & ToPreviousSibling (void);
+
+    // navigation (end)
+    ///////
+    // reading (begin)
+
+    const char * ReadName (void) const;
+    bool         ReadBool (void) const;
+    int          ReadInt (void) const;
+    float        ReadFloat (void) const;
+    const char * ReadString (void) const;
+
+    // RETURNS: true on success (and the out parameter is written to).
+    //          false otherwise, and the out parameter is not written to.
+    bool ReadBoolSafe (bool * outBool) const;
+    bool ReadIntSafe (int * outInt) const;
+    bool ReadFloatSafe (float * outFloat) const;
+    bool ReadStringSafe (char * outString, int bufferSizeInElements) const;
+
+    inline bool ReadBoolWalk (void)                    {
+        const bool result = ReadBool();
+        ToNextSibling();
+        return result;
+    }
+
+    inline int ReadIntWalk (void)                      {
+        const int result = ReadInt();
+        ToNextSibling();
+        return result;
+    }
+
+    inline float ReadFloatWalk (void)                  {
+        const float result = ReadFloat();
+        ToNextSibling();
+        return result;
+    }
+
+    inline const char * ReadStringWalk (void)          {
+        const char * result = ReadString();
+        ToNextSibling();
+        return result;
+    }
+
+    // reading (end)
+    ///////
+
+    OffsetDataMapReader (void) = delete;
+};
+
+} // namespace CSaruDataMap
@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DataNode.hpp"
+
+namespace CSaruDataMap {
+
+// One node of a frozen, pointer-free DataMap image.  Everything is an index
+//  or a byte offset relative to the image, so an image can be placed
+//  anywhere (shared memory, a mapped file, a constant array) and read in
+//  place by an OffsetDataMapReader.
+//
+// A node's children are contiguous in the node array, starting at
+//  m_childBegin.  Names and strings are null-terminated, in a string table
+//  after the nodes.
+struct OffsetDataNode {
+    std::uint32_t m_nameOffset;     // into the string table
+    std::uint32_t m_nameHash;       // DataKey::HashName() of the name
+    std::uint32_t m_childBegin;     // node index of the first child
+    std::uint32_t m_childCount;
+    // Bool: 0 or 1.  Int: the int's bits.  Float: the float's bits.
+    //  String: offset into the string table.  Anything else: 0.
+    std::uint32_t m_value;
+    std::uint8_t  m_type;           // a DataNode::Type
+    std::uint8_t  m_padding[3];
+
+    inline DataNode::Type GetType (void) const         { return DataNode::Type(m_type); }
+    inline bool IsContainerType (void) const           { return GetType() == DataNode::Type::Object || GetType() == DataNode::Type::Array; }
+};
+
+// An image is this header, then m_nodeCount OffsetDataNodes (the root
+//  first), then m_stringBytes of string table.  The string table always
+//  starts with "" and ends with a null.
+struct OffsetDataMapHeader {
+    std::uint32_t m_magic;
+    std::uint32_t m_nodeCount;
+    std::uint32_t m_stringBytes;
+    std::uint32_t m_imageSize;
+};
+
+// Builds and checks OffsetDataNode images.
+class OffsetDataMapImage {
+public:
+    // Type and Constants
+    static const std::uint32_t s_magic = 0x314D444F;  // "ODM1", little-endian
+
+    // Methods
+    // replaces out with root's image.  Children are laid out breadth-first;
+    //  equal names and strings are stored once.
+    static void Build (const DataNode & root, std::vector<std::uint8_t> * out);
+
+    // checks that image holds a whole, well-formed image: every index and
+    //  offset in range, every string terminated and short enough for a
+    //  DataNode, and the nodes in Build()'s breadth-first order.
+    // RETURNS: false if not.  O(nodes).
+    static bool Validate (const void * image, std::size_t size);
+
+    // WARNING: These assume a Validate()d image.
+    static inline const OffsetDataMapHeader * GetHeader (const void * image) {
+        return static_cast<const OffsetDataMapHeader *>(image);
+    }
+    static inline const OffsetDataNode * GetNodes (const void * image) {
+        return reinterpret_cast<const OffsetDataNode *>(static_cast<const std::uint8_t *>(image) + sizeof(OffsetDataMapHeader));
+    }
+    static inline const char * GetStrings (const void * image) {
+        return reinterpret_cast<const char *>(GetNodes(image) + GetHeader(image)->m_nodeCount);
+    }
+
+    // rebuilds a DataNode tree from an image, starting at the node at index
+    //  root.  outRoot takes that node's name.
+    static void ToDataNode (const OffsetDataNode * nodes, const char * strings, DataNode * outRoot, std::uint32_t root = 0);
+
+    OffsetDataMapImage (void) = delete;
+};
+
+} // namespace CSaruDataMap
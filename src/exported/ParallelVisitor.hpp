@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "DataNode.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace CSaruDataMap {
+
+// Map-reduce over every node of a subtree, spread across a WorkStealingPool:
+//
+//      int intCount = ParallelMapReduce(pool, root, 0,
+//          [](const DataNode & node) { return node.GetType() == DataNode::Type::Int ? 1 : 0; },
+//          [](int a, int b) { return a + b; });
+//
+// map is called once per node (root included).  combine must be associative,
+//  and identity must be its identity; results are combined in the map's
+//  pre-order, so combine need not be commutative.  Both are called from many
+//  threads at once and must not throw.
+//
+// Work is split along runs of sibling nodes.  A run is cut in half (and one
+//  half offered to the pool) while it has more than grainSize nodes, or more
+//  than grainSize children between them.  Runs smaller than that are visited
+//  on the current thread, descending into their children the same way.  The
+//  calling thread works too, and returns once everything is done.
+//
+// WARNING: The map must not be changed while this is running.
+namespace ParallelVisitorDetail {
+
+    template <typename Result, typename Map, typename Combine>
+    class MapReduceJob {
+    private:
+        // Data
+        WorkStealingPool * m_pool;
+        const Map *        m_map;
+        const Combine *    m_combine;
+        const Result *     m_identity;
+        int                m_grainSize;
+
+        // Helpers
+        inline bool ShouldSplit (const DataNode * begin, const DataNode * end) const {
+            const int count = int(end - begin);
+            if (count < 2)
+                return false;
+            if (count > m_grainSize)
+                return true;
+
+            int childCount = 0;
+            for (const DataNode * node = begin;  node != end;  ++node)
+                childCount += node->GetChildCount();
+            return childCount > m_grainSize;
+        }
+
+    public:
+        // Methods
+        MapReduceJob (
+            WorkStealingPool * pool,
+            const Map *        map,
+            const Combine *    combine,
+            const Result *     identity,
+            int                grainSize
+        )
+            : m_pool(pool)
+            , m_map(map)
+            , m_combine(combine)
+            , m_identity(identity)
+            , m_grainSize(grainSize > 0 ? grainSize : 1)
+        {}
+
+        Result VisitRange (const DataNode * begin, const DataNode * end) const {
+            if (ShouldSplit(begin, end)) {
+                const DataNode * middle = begin + (end - begin) / 2;
+
+                Result            rightResult(*m_identity);
+                std::atomic<bool> rightDone(false);
+                m_pool->Submit([this, middle, end, &rightResult, &rightDone] () {
+                    rightResult = VisitRange(middle, end);
+                    rightDone.store(true, std::memory_order_release);
+                });
+
+                const Result leftResult = VisitRange(begin, middle);
+                m_pool->HelpUntil([&rightDone] () { return rightDone.load(std::memory_order_acquire); });
+                return (*m_combine)(leftResult, rightResult);
+            }
+
+            Result result(*m_identity);
+            for (const DataNode * node = begin;  node != end;  ++node)
+                result = (*m_combine)(result, VisitNode(*node));
+            return result;
+        }
+
+        Result VisitNode (const DataNode & node) const {
+            Result result = (*m_map)(node);
+            if (node.HasChildren()) {
+                const DataNode * first = node.GetChildFast(0);
+                result = (*m_combine)(result, VisitRange(first, first + node.GetChildCount()));
+            }
+            return result;
+        }
+    };
+
+} // namespace ParallelVisitorDetail
+
+//=========================================================================
+template <typename Result, typename Map, typename Combine>
+Result ParallelMapReduce (
+    WorkStealingPool & pool,
+    const DataNode &   root,
+    Result             identity,
+    Map                map,
+    Combine            combine,
+    int                grainSize = 1024
+) {
+    const ParallelVisitorDetail::MapReduceJob<Result, Map, Combine> job(&pool, &map, &combine, &identity, grainSize);
+    return job.VisitNode(root);
+}
+
+//=========================================================================
+// calls visit once per node in the subtree, from many threads at once.
+template <typename Visit>
+void ParallelForEachNode (
+    WorkStealingPool & pool,
+    const DataNode &   root,
+    Visit              visit,
+    int                grainSize = 1024
+) {
+    ParallelMapReduce(
+        pool,
+        root,
+        0,
+        [&visit] (const DataNode & node) { visit(node); return 0; },
+        [] (int, int) { return 0; },
+        grainSize
+    );
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,156 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+#include "DataMapMutator.hpp"
+#include "DataMapReader.hpp"
+
+namespace CSaruDataMap {
+
+// An Object-rooted map whose top-level keys are partitioned by hash across a
+//  fixed number of independently locked shards.  Threads updating keys that
+//  land in different shards never contend with one another.
+//
+// Each shard's root is an Object node holding that shard's top-level keys.
+//  Within a shard, children keep their insertion order; across shards, the
+//  order of top-level keys is by shard, then by insertion.
+class ShardedDataMap {
+public:
+    // Type and Constants
+    static const unsigned s_defaultShardCount = 16;
+
+    // Holds its shard's lock for as long as it lives.  The Mutator it hands out
+    //  must not be used after the LockedMutator is destroyed.
+    class LockedMutator {
+    private:
+        // Data
+        std::unique_lock<std::mutex> m_lock;
+        DataMapMutator               m_mutator;
+
+    public:
+        // Methods
+        LockedMutator (std::mutex & mutex, DataNode * shardRoot);
+
+        inline DataMapMutator & GetMutator (void)          { return m_mutator; }
+        inline DataMapMutator * operator-> (void)          { return &m_mutator; }
+    };
+
+    // Holds its shard's lock for as long as it lives.  The Reader it hands out
+    //  must not be used after the LockedReader is destroyed.
+    class LockedReader {
+    private:
+        // Data
+        std::unique_lock<std::mutex> m_lock;
+        DataMapReader                m_reader;
+
+    public:
+        // Methods
+        LockedReader (std::mutex & mutex, const DataNode * shardRoot);
+
+        inline DataMapReader & GetReader (void)            { return m_reader; }
+        inline DataMapReader * operator-> (void)           { return &m_reader; }
+    };
+
+    // Holds every shard's lock, giving a consistent view of the whole map.
+    //  Shards are always locked in index order, so these never deadlock
+    //  against one another.
+    class WholeMapLock {
+    private:
+        // Data
+        const ShardedDataMap *                    m_map;
+        std::vector<std::unique_lock<std::mutex>> m_locks;
+
+    public:
+        // Methods
+        explicit WholeMapLock (const ShardedDataMap & map);
+
+        int GetShardCount (void) const;
+        DataMapReader GetShardReader (int shardIndex) const;
+
+        // RETURNS: the total number of top-level keys across all shards.
+        int GetChildCount (void) const;
+
+        // calls func(const DataNode &) for every top-level child, shard by shard.
+        template <typename Func>
+        void ForEachChild (Func func) const;
+
+        // replaces dest's contents with a single Object holding every top-level
+        //  child of every shard.
+        // WARNING: potentially VERY SLOW.  Copies the entire map.
+        void CopyTo (DataNode * dest) const;
+    };
+
+private:
+    // Types
+    struct Shard {
+        std::mutex m_mutex;
+        DataNode   m_root;
+        // keeps one shard's hot data off of the next shard's cache line.
+        char       m_padding[64];
+    };
+
+    // Data
+    Shard *  m_shards;
+    unsigned m_shardCount;
+
+public:
+    // Methods
+    explicit ShardedDataMap (unsigned shardCount = s_defaultShardCount);
+    ~ShardedDataMap ();
+
+    inline unsigned GetShardCount (void) const         { return m_shardCount; }
+    unsigned GetShardIndex (const char * key) const;
+
+    // locks the shard which owns key, and returns a Mutator pointing at key's
+    //  node.  If no such key exists, a new null node will be added for it.
+    LockedMutator LockForWrite (const char * key);
+
+    // locks the shard which owns key, and returns a Reader pointing at key's
+    //  node.  If no such key exists, the Reader will be invalid.
+    LockedReader LockForRead (const char * key) const;
+
+    // locks the given shard, and returns a Mutator/Reader at its root.
+    LockedMutator LockShardForWrite (unsigned shardIndex);
+    LockedReader LockShardForRead (unsigned shardIndex) const;
+
+    inline WholeMapLock LockWholeMap (void) const      { return WholeMapLock(*this); }
+
+    DISALLOW_COPY_AND_ASSIGN(ShardedDataMap)
+};
+
+//=========================================================================
+template <typename Func>
+void ShardedDataMap::WholeMapLock::ForEachChild (Func func) const {
+    for (unsigned s = 0;  s < m_map->m_shardCount;  ++s) {
+        const DataNode & root = m_map->m_shards[s].m_root;
+        const int childCount = root.GetChildCount();
+        for (int i = 0;  i < childCount;  ++i)
+            func(*root.GetChildFast(i));
+    }
+}
+
+} // namespace CSaruDataMap
@@ -0,0 +1,129 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+#include "DataNode.hpp"
+#include "OffsetDataMapReader.hpp"
+
+namespace CSaruDataMap {
+
+// A DataMap image in a named POSIX shared memory segment: one writer process
+//  publishes, any number of reader processes read it in place.  Every
+//  process maps the same physical pages, so memory use doesn't grow with the
+//  number of readers.
+//
+//      // writer                           // each reader
+//      SharedDataMap map;                  SharedDataMap map;
+//      map.Create("/config", 1 << 20);     map.Attach("/config");
+//      map.Publish(root);                  for (;;) {
+//                                              OffsetDataMapReader reader = map.Read();
+//                                              int port = reader.ToChild("port").ReadInt();
+//                                              if (!reader.IsStale())
+//                                                  break;
+//                                          }
+//
+// The segment holds two buffers.  Publish() writes the new image into the
+//  one readers aren't being sent to, then flips them, bumping a seqlock
+//  sequence before and after.  A reader is only invalidated if two publishes
+//  start while it reads, so retries are rare; readers never block the
+//  writer, and never write to the segment.
+//
+// NOTE: POSIX only.  Elsewhere, Create() and Attach() fail.
+class SharedDataMap {
+private:
+    // Types
+    // at the start of the segment, followed by the two buffers.
+    struct Control {
+        std::uint32_t              m_magic;
+        std::uint32_t              m_bufferSize;
+        // odd while Publish() writes.  sequence / 2 is the number of images
+        //  published, and (sequence / 2) % 2 the buffer readers should use.
+        std::atomic<std::uint64_t> m_sequence;
+    };
+
+    // Type and Constants
+    static const std::uint32_t s_magic         = 0x314D4453;  // "SDM1", little-endian
+    static const std::size_t   s_bufferAlign   = 64;
+
+    // Data
+    std::string               m_name;
+    std::uint8_t *            m_segment;
+    std::size_t               m_segmentSize;
+    bool                      m_isWriter;
+    std::vector<std::uint8_t> m_image;          // writer's scratch
+
+    // Helpers
+    inline Control * GetControl (void) const           { return reinterpret_cast<Control *>(m_segment); }
+    std::uint8_t * GetBuffer (int index) const;
+    bool Map (int fd, std::size_t size, bool writable);
+
+public:
+    // Methods
+    SharedDataMap (void);
+    // unmaps the segment, but doesn't remove it.
+    ~SharedDataMap ();
+
+    // creates (or replaces) the segment called name, with room for images
+    //  under bufferSize bytes, and publishes an empty Object.
+    // NOTE: A segment being replaced is unlinked, not overwritten, so readers
+    //  still attached to it keep reading its last image, undisturbed.  They
+    //  must Attach() again to see the new one.
+    // RETURNS: false if the segment can't be made, or another process made
+    //  one of the same name at the same moment.
+    bool Create (const char * name, std::size_t bufferSize);
+
+    // maps an existing segment read-only.
+    // RETURNS: false if there is no such segment, or it isn't a SharedDataMap.
+    bool Attach (const char * name);
+
+    void Detach (void);
+
+    inline bool IsAttached (void) const                { return m_segment != nullptr; }
+    inline bool IsWriter (void) const                  { return m_isWriter; }
+
+    // writer only.  Builds root's image and makes it the one readers see.
+    // RETURNS: false if the image won't fit in a buffer.
+    bool Publish (const DataNode & root);
+
+    // RETURNS: how many images have been published since Create().
+    std::uint64_t GetVersion (void) const;
+
+    // RETURNS: a Reader at the root of the latest image.  See
+    //  OffsetDataMapReader::IsStale() for validating what it reads.
+    OffsetDataMapReader Read (void) const;
+
+    // removes the segment called name.  Processes which have it mapped keep
+    //  their mapping.
+    static bool Remove (const char * name);
+
+    DISALLOW_COPY_AND_ASSIGN(SharedDataMap)
+};
+
+} // namespace CSaruDataMap
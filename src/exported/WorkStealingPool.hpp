@@ -0,0 +1,101 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <csaru-core-cpp/csaru-core-cpp.hpp>
+
+namespace CSaruDataMap {
+
+// A fixed set of worker threads, each with its own task deque.  A worker runs
+//  the newest task from its own deque, and when that's empty steals the
+//  oldest from another worker's.  Tasks submitted from a worker go to that
+//  worker's deque, so work split off by a task tends to stay on its thread
+//  until someone idle comes for it.
+//
+// Threads waiting on other tasks should HelpUntil() rather than block, so
+//  that waiting inside a task can't starve the pool.
+class WorkStealingPool {
+public:
+    // Type and Constants
+    typedef std::function<void ()> Task;
+
+private:
+    // Types
+    struct Worker {
+        std::mutex       m_mutex;
+        std::deque<Task> m_tasks;
+        char             m_padding[64];
+    };
+
+    // Helpers
+    bool PopTask (int self, Task * outTask);
+    void WorkerMain (int index);
+    int GetCurrentWorkerIndex (void) const;
+
+    // Data
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread>             m_threads;
+    std::atomic<int>                     m_queuedCount;
+    std::atomic<unsigned>                m_nextWorker;
+    std::atomic<bool>                    m_stopping;
+    std::atomic<int>                     m_sleeperCount;  // workers in (or about to enter) m_wake.wait()
+    std::mutex                           m_sleepMutex;
+    std::condition_variable              m_wake;
+
+public:
+    // Methods
+    // threadCount of 0 uses one thread per hardware thread.
+    explicit WorkStealingPool (unsigned threadCount = 0);
+
+    // runs every task still queued, then joins the workers.
+    ~WorkStealingPool ();
+
+    inline unsigned GetThreadCount (void) const { return unsigned(m_threads.size()); }
+
+    // NOTE: Tasks must not throw.
+    void Submit (Task task);
+
+    // runs one queued task on the calling thread, if there is one.
+    // RETURNS: true if a task was run.
+    bool TryRunOne (void);
+
+    // runs queued tasks on the calling thread until done() returns true.
+    template <typename Done>
+    inline void HelpUntil (Done done) {
+        while (!done()) {
+            if (!TryRunOne())
+                std::this_thread::yield();
+        }
+    }
+
+    DISALLOW_COPY_AND_ASSIGN(WorkStealingPool)
+};
+
+} // namespace CSaruDataMap
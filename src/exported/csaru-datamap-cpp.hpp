@@ -5,3 +5,31 @@
 #include <csaru-datamap-cpp/DataMapReader.hpp>
 #include <csaru-datamap-cpp/DataMapMutator.hpp>
 #include <csaru-datamap-cpp/DataMapReaderSimple.hpp>
+#include <csaru-datamap-cpp/ConcurrentDataMap.hpp>
+#include <csaru-datamap-cpp/ShardedDataMap.hpp>
+#include <csaru-datamap-cpp/DataNodeHandle.hpp>
+#include <csaru-datamap-cpp/DataNodeCursor.hpp>
+#include <csaru-datamap-cpp/DataPath.hpp>
+#include <csaru-datamap-cpp/DataKey.hpp>
+#include <csaru-datamap-cpp/DataBinding.hpp>
+#include <csaru-datamap-cpp/DataSchema.hpp>
+#include <csaru-datamap-cpp/DataMapPolicy.hpp>
+#include <csaru-datamap-cpp/BasicDataMapCursor.hpp>
+#include <csaru-datamap-cpp/DataNodeRange.hpp>
+#include <csaru-datamap-cpp/WorkStealingPool.hpp>
+#include <csaru-datamap-cpp/ParallelVisitor.hpp>
+#include <csaru-datamap-cpp/DataPatch.hpp>
+#include <csaru-datamap-cpp/DataMapOverlay.hpp>
+#include <csaru-datamap-cpp/DataMapTransaction.hpp>
+#include <csaru-datamap-cpp/DataMapMutatorListener.hpp>
+#include <csaru-datamap-cpp/DataMapBinary.hpp>
+#include <csaru-datamap-cpp/DataMapJournal.hpp>
+#include <csaru-datamap-cpp/DataMapSnapshotter.hpp>
+#include <csaru-datamap-cpp/OffsetDataNode.hpp>
+#include <csaru-datamap-cpp/OffsetDataMapReader.hpp>
+#include <csaru-datamap-cpp/SharedDataMap.hpp>
+#include <csaru-datamap-cpp/MappedDataMap.hpp>
+#include <csaru-datamap-cpp/DataMapParseCache.hpp>
+#include <csaru-datamap-cpp/DataMapCodeGenerator.hpp>
+#include <csaru-datamap-cpp/DataMapLoader.hpp>
+#include <csaru-datamap-cpp/DataMapGenerator.hpp>
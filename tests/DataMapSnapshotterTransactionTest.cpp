@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2016 Christopher Higgins Barrett
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+// A DataMapTransaction passing calls on to a running DataMapSnapshotter must
+//  still be able to roll back what it logged, and the snapshot must still
+//  hold the tree as it was at Start().
+//
+// Built against the library; exits non-zero on failure:
+//
+//      c++ -std=c++11 -pthread -I<include dir> DataMapSnapshotterTransactionTest.cpp -lcsaru-datamap-cpp
+
+#include <cstdio>
+#include <cstring>
+
+#include <csaru-datamap-cpp/csaru-datamap-cpp.hpp>
+
+using namespace CSaruDataMap;
+
+static const int   s_childCount   = 2000;
+static const int   s_elementCount = 50;
+static const char  s_path[]       = "DataMapSnapshotterTransactionTest.snapshot";
+
+static int s_failures = 0;
+
+//=========================================================================
+static void Check (bool condition, const char * what) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++s_failures;
+    }
+}
+
+//=========================================================================
+static bool SameTree (const DataNode & a, const DataNode & b) {
+    if (
+        std::strcmp(a.GetName(), b.GetName()) != 0 ||
+        a.GetType() != b.GetType() ||
+        a.GetChildCount() != b.GetChildCount()
+    ) {
+        return false;
+    }
+    if (a.GetType() == DataNode::Type::Int && a.GetInt() != b.GetInt())
+        return false;
+
+    for (int i = 0;  i < a.GetChildCount();  ++i) {
+        if (!SameTree(*a.GetChildFast(i), *b.GetChildFast(i)))
+            return false;
+    }
+    return true;
+}
+
+//=========================================================================
+static void BuildTree (DataNode * root) {
+    root->SetType(DataNode::Type::Array);
+    for (int c = 0;  c < s_childCount;  ++c) {
+        DataNode * child = root->AppendNewChild();
+        child->SetType(DataNode::Type::Array);
+        for (int e = 0;  e < s_elementCount;  ++e)
+            child->AppendNewChild()->SetInt(c * s_elementCount + e);
+    }
+}
+
+//=========================================================================
+// deletes one child and replaces another while the snapshot runs, then rolls
+//  back once it's done.
+static void TestRollbackAfterSnapshot (void) {
+    DataNode root;
+    BuildTree(&root);
+    const DataNode original(root);
+
+    DataMapSnapshotter snapshotter(&root);
+    DataMapTransaction transaction(&root, &snapshotter);
+    DataMapMutator     mutator = transaction.GetMutator();
+
+    transaction.Begin();
+    Check(snapshotter.Start(s_path), "snapshot starts");
+
+    mutator.DeleteChild(s_childCount - 1);
+    mutator.ToChild(s_childCount - 3).WriteNode(DataNode());
+    mutator.PopNode();
+
+    Check(snapshotter.Wait(), "snapshot written");
+    transaction.Rollback();
+
+    Check(root.GetChildCount() == s_childCount, "rollback restores the deleted child");
+    Check(root.GetChildFast(s_childCount - 1)->GetChildCount() == s_elementCount, "deleted child keeps its children");
+    Check(root.GetChildFast(s_childCount - 3)->GetChildCount() == s_elementCount, "replaced child keeps its children");
+    Check(SameTree(root, original), "rollback restores the tree");
+
+    DataNode loaded;
+    Check(DataMapBinary::LoadSnapshot(s_path, &loaded), "snapshot loads");
+    loaded.SetName(original.GetName());
+    Check(SameTree(loaded, original), "snapshot holds the tree as it was at Start()");
+}
+
+//=========================================================================
+// the same changes, committed while the snapshot may still need them.
+static void TestCommitDuringSnapshot (void) {
+    DataNode root;
+    BuildTree(&root);
+    const DataNode original(root);
+
+    DataMapSnapshotter snapshotter(&root);
+    DataMapTransaction transaction(&root, &snapshotter);
+    DataMapMutator     mutator = transaction.GetMutator();
+
+    transaction.Begin();
+    Check(snapshotter.Start(s_path), "snapshot starts");
+
+    mutator.DeleteChild(s_childCount - 1);
+    mutator.ToChild(s_childCount - 3).WriteNode(DataNode());
+    mutator.PopNode();
+    transaction.Commit();
+
+    Check(snapshotter.Wait(), "snapshot written");
+    Check(root.GetChildCount() == s_childCount - 1, "commit keeps the delete");
+    Check(root.GetChildFast(s_childCount - 3)->GetChildCount() == 0, "commit keeps the replacement");
+
+    DataNode loaded;
+    Check(DataMapBinary::LoadSnapshot(s_path, &loaded), "snapshot loads");
+    loaded.SetName(original.GetName());
+    Check(SameTree(loaded, original), "snapshot holds the tree as it was at Start()");
+}
+
+//=========================================================================
+int main (void) {
+    TestRollbackAfterSnapshot();
+    TestCommitDuringSnapshot();
+    std::remove(s_path);
+
+    if (s_failures == 0)
+        printf("DataMapSnapshotterTransactionTest passed.\n");
+    return s_failures == 0 ? 0 : 1;
+}